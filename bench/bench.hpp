@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esb {
+namespace bench {
+
+// Number of calls to the global operator new, maintained by the replacement allocation functions
+// in the benchmark executable so that each case can report its allocations per operation.
+inline std::atomic<size_t> allocationCount{0};
+
+template <typename T>
+void doNotOptimize(const T& val) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(val) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &val;
+#endif
+}
+
+struct Result {
+    std::string name;
+    double      nsPerOp;
+    double      bytesPerSec;
+    double      valuesPerSec;
+    double      allocsPerOp;
+};
+
+class Suite {
+public:
+    // Registers a case; bytesPerOp and valuesPerOp describe the work done by a single call to fn
+    // and are used to derive throughput.
+    template <typename Fn>
+    void add(std::string name, size_t bytesPerOp, size_t valuesPerOp, Fn fn) {
+        auto batch = [fn](size_t iterations) mutable {
+            for (size_t i = 0; i < iterations; ++i) {
+                fn();
+            }
+        };
+
+        cases_.push_back({std::move(name), bytesPerOp, valuesPerOp, std::move(batch)});
+    }
+
+    // Usage: [--format=text|csv|json] [--filter=substring] [--min-time-ms=N]
+    int run(int argc, char** argv) {
+        std::string format    = "text";
+        std::string filter    = "";
+        double      minTimeNs = 100e6;
+
+        for (int i = 1; i < argc; ++i) {
+            if (std::strncmp(argv[i], "--format=", 9) == 0) {
+                format = argv[i] + 9;
+            } else if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+                filter = argv[i] + 9;
+            } else if (std::strncmp(argv[i], "--min-time-ms=", 14) == 0) {
+                minTimeNs = std::atof(argv[i] + 14) * 1e6;
+            } else {
+                std::fprintf(stderr,
+                             "usage: %s [--format=text|csv|json] [--filter=substring] "
+                             "[--min-time-ms=N]\n",
+                             argv[0]);
+                return 1;
+            }
+        }
+
+        std::vector<Result> results;
+        for (auto& benchCase : cases_) {
+            if (benchCase.name.find(filter) != std::string::npos) {
+                results.push_back(measure(benchCase, minTimeNs));
+            }
+        }
+
+        if (format == "csv") {
+            printCsv(results);
+        } else if (format == "json") {
+            printJson(results);
+        } else {
+            printText(results);
+        }
+
+        return 0;
+    }
+
+private:
+    struct Case {
+        std::string                 name;
+        size_t                      bytesPerOp;
+        size_t                      valuesPerOp;
+        std::function<void(size_t)> fn;
+    };
+
+    static double elapsedNs(const Case& benchCase, size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        benchCase.fn(iterations);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    // Grows the iteration count until a batch takes a measurable amount of time, then times a
+    // batch sized to run for roughly minTimeNs.
+    static Result measure(const Case& benchCase, double minTimeNs) {
+        size_t iterations = 1;
+        double elapsed    = elapsedNs(benchCase, iterations);
+        while (elapsed < minTimeNs / 10 && iterations < (size_t{1} << 40)) {
+            iterations *= 10;
+            elapsed = elapsedNs(benchCase, iterations);
+        }
+
+        iterations = static_cast<size_t>(iterations * (minTimeNs / (elapsed > 0 ? elapsed : 1)));
+        if (iterations == 0) {
+            iterations = 1;
+        }
+
+        size_t allocations = allocationCount.load();
+        elapsed            = elapsedNs(benchCase, iterations);
+        allocations        = allocationCount.load() - allocations;
+
+        double nsPerOp = elapsed / iterations;
+        return {benchCase.name, nsPerOp, benchCase.bytesPerOp * 1e9 / nsPerOp,
+                benchCase.valuesPerOp * 1e9 / nsPerOp,
+                static_cast<double>(allocations) / iterations};
+    }
+
+    static void printText(const std::vector<Result>& results) {
+        std::printf("%-56s %12s %12s %12s %10s\n", "name", "ns/op", "MB/s", "Mvalues/s",
+                    "allocs/op");
+        for (auto& result : results) {
+            std::printf("%-56s %12.2f %12.2f %12.2f %10.2f\n", result.name.c_str(), result.nsPerOp,
+                        result.bytesPerSec / 1e6, result.valuesPerSec / 1e6, result.allocsPerOp);
+        }
+    }
+
+    static void printCsv(const std::vector<Result>& results) {
+        std::printf("name,ns_per_op,bytes_per_sec,values_per_sec,allocs_per_op\n");
+        for (auto& result : results) {
+            std::printf("\"%s\",%.3f,%.0f,%.0f,%.3f\n", result.name.c_str(), result.nsPerOp,
+                        result.bytesPerSec, result.valuesPerSec, result.allocsPerOp);
+        }
+    }
+
+    static void printJson(const std::vector<Result>& results) {
+        std::printf("[\n");
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto& result = results[i];
+            std::printf("  {\"name\": \"%s\", \"ns_per_op\": %.3f, \"bytes_per_sec\": %.0f, "
+                        "\"values_per_sec\": %.0f, \"allocs_per_op\": %.3f}%s\n",
+                        result.name.c_str(), result.nsPerOp, result.bytesPerSec,
+                        result.valuesPerSec, result.allocsPerOp, i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+
+    std::vector<Case> cases_;
+};
+
+}  // namespace bench
+}  // namespace esb
@@ -0,0 +1,766 @@
+#include "bench.hpp"
+
+#include "buffer_reader.hpp"
+#include "buffer_writer.hpp"
+#include "checked.hpp"
+#include "dispatch.hpp"
+#include "framing.hpp"
+#include "gather_writer.hpp"
+#include "incremental_decoder.hpp"
+#include "inline_writer.hpp"
+#include "mapped_file_reader.hpp"
+#include "segmented_reader.hpp"
+#include "serialization.hpp"
+#include "unicode.hpp"
+#include "varint.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Every replacement allocation function below counts the call and allocates with malloc, or
+// aligned_alloc (_aligned_malloc on MSVC, which has no aligned_alloc), and every replacement
+// deallocation function frees through release. It is kept out of line because GCC otherwise
+// inlines the free into callers of operator delete and reports it as mismatched with their
+// operator new (-Wmismatched-new-delete).
+void* allocate(size_t size, size_t alignment = 0) noexcept {
+    ++esb::bench::allocationCount;
+
+    if (alignment == 0) {
+        return std::malloc(size != 0 ? size : 1);
+    }
+
+#if defined(_MSC_VER)
+    return _aligned_malloc(size != 0 ? size : 1, alignment);
+#else
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    size = size != 0 ? (size + alignment - 1) / alignment * alignment : alignment;
+    return std::aligned_alloc(alignment, size);
+#endif
+}
+
+void* allocateOrThrow(size_t size, size_t alignment = 0) {
+    if (void* ptr = allocate(size, alignment)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noinline))
+#endif
+void release(void* ptr, bool aligned = false) noexcept {
+#if defined(_MSC_VER)
+    if (aligned) {
+        _aligned_free(ptr);
+        return;
+    }
+#else
+    (void)aligned;
+#endif
+
+    std::free(ptr);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    return allocateOrThrow(size);
+}
+
+void* operator new[](size_t size) {
+    return allocateOrThrow(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return allocateOrThrow(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    release(ptr, true);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    release(ptr, true);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    release(ptr, true);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    release(ptr, true);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    release(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    release(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(ptr, true);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    release(ptr, true);
+}
+
+namespace {
+
+using esb::bench::doNotOptimize;
+using esb::bench::Suite;
+
+constexpr size_t kFieldCount     = 64;
+constexpr size_t kInlineCapacity = 8192;
+
+// Scratch file for the mapped file cases, kept in the temporary directory rather than wherever the
+// bench is run from.
+const std::string& snapshotPath() {
+    static const std::string path =
+        (std::filesystem::temp_directory_path() / "esb_bench_snapshot.bin").string();
+    return path;
+}
+
+enum class Opcode : uint32_t { LOGIN = 1, CHAT = 2 };
+
+struct PositionUpdate {
+    uint64_t id;
+    float    x;
+    float    y;
+    float    z;
+    uint16_t heading;
+
+    ESB_FIELDS(id, x, y, z, heading)
+};
+
+#pragma pack(push, 1)
+struct WirePositionUpdate {
+    uint64_t id;
+    float    x;
+    float    y;
+    float    z;
+    uint16_t heading;
+
+    ESB_FIELDS(id, x, y, z, heading)
+};
+#pragma pack(pop)
+
+}  // namespace
+
+template <>
+struct esb::is_wire_compatible<WirePositionUpdate> : std::true_type {};
+
+namespace {
+
+template <typename T>
+std::string serializeRepeated(const T& val, size_t count) {
+    esb::BufferWriter writer;
+    for (size_t i = 0; i < count; ++i) {
+        esb::write(writer, val);
+    }
+    return {writer.data(), writer.size()};
+}
+
+// Registers cases reading and writing `count` copies of val through each stream type.
+template <typename T>
+void addValueCases(Suite& suite, const std::string& type, const T& val,
+                   size_t count = kFieldCount) {
+    auto payload = serializeRepeated(val, count);
+    auto bytes   = payload.size();
+
+    // The stream is built once and rewound for each operation, so that, like the BufferReader
+    // case, only the reads are timed and not a copy of the payload.
+    auto ss =
+        std::make_shared<std::stringstream>(payload, std::ios_base::in | std::ios_base::binary);
+    suite.add("read<" + type + ">/stringstream", bytes, count, [ss, count] {
+        ss->clear();
+        ss->seekg(0);
+        for (size_t i = 0; i < count; ++i) {
+            doNotOptimize(esb::read<T>(*ss));
+        }
+    });
+
+    suite.add("read<" + type + ">/BufferReader", bytes, count, [payload, count] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        for (size_t i = 0; i < count; ++i) {
+            doNotOptimize(esb::read<T>(reader));
+        }
+    });
+
+    suite.add("write<" + type + ">/ostringstream", bytes, count, [val, count] {
+        std::ostringstream os{std::stringstream::binary};
+        for (size_t i = 0; i < count; ++i) {
+            esb::write(os, val);
+        }
+        doNotOptimize(os.tellp());
+    });
+
+    suite.add("write<" + type + ">/BufferWriter", bytes, count, [val, count] {
+        esb::BufferWriter writer;
+        for (size_t i = 0; i < count; ++i) {
+            esb::write(writer, val);
+        }
+        doNotOptimize(writer.data());
+    });
+
+    if (bytes <= kInlineCapacity) {
+        suite.add("write<" + type + ">/InlineWriter", bytes, count, [val, count] {
+            esb::InlineWriter<kInlineCapacity> writer;
+            for (size_t i = 0; i < count; ++i) {
+                esb::write(writer, val);
+            }
+            doNotOptimize(writer.data());
+        });
+    }
+}
+
+void addIntegralCases(Suite& suite) {
+    addValueCases(suite, "int8_t", int8_t{-8});
+    addValueCases(suite, "uint8_t", uint8_t{254});
+    addValueCases(suite, "int16_t", int16_t{-8});
+    addValueCases(suite, "uint16_t", uint16_t{254});
+    addValueCases(suite, "int32_t", int32_t{-8});
+    addValueCases(suite, "uint32_t", uint32_t{254});
+    addValueCases(suite, "int64_t", int64_t{-8});
+    addValueCases(suite, "uint64_t", uint64_t{254});
+    addValueCases(suite, "bool", true);
+    addValueCases(suite, "float", 1.5f);
+    addValueCases(suite, "double", 1.5);
+    addValueCases(suite, "enum", Opcode::CHAT);
+
+    auto payload = serializeRepeated(uint16_t{0x1234}, kFieldCount);
+    suite.add("read<uint16_t,big_endian>/BufferReader", payload.size(), kFieldCount, [payload] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        for (size_t i = 0; i < kFieldCount; ++i) {
+            doNotOptimize(esb::read<uint16_t>(reader, esb::big_endian{}));
+        }
+    });
+}
+
+void addVarintCases(Suite& suite) {
+    addValueCases(suite, "varint<uint64_t> 1 byte", esb::varint<uint64_t>{100});
+    addValueCases(suite, "varint<uint64_t> 3 bytes", esb::varint<uint64_t>{1u << 20});
+    addValueCases(suite, "zigzag<int32_t>", esb::zigzag<int32_t>{-100});
+
+    std::vector<uint64_t> ids(4096);
+    esb::BufferWriter     writer;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        esb::write(writer, esb::varint<uint64_t>{(i * 2654435761u) % (1u << 20)});
+    }
+
+    // Ids below 2^20 encode in one to three bytes, almost all of them three.
+    std::string payload{writer.data(), writer.size()};
+    suite.add("decodeVarint<uint64_t> loop x4096", payload.size(), ids.size(),
+              [payload, ids]() mutable {
+                  const char* ptr = payload.data();
+                  const char* end = ptr + payload.size();
+                  for (auto& id : ids) {
+                      esb::decodeVarint(ptr, end, id);
+                  }
+                  doNotOptimize(ids);
+              });
+
+    suite.add("decodeVarints<uint64_t> x4096", payload.size(), ids.size(),
+              [payload, ids]() mutable {
+                  doNotOptimize(
+                      esb::decodeVarints(payload.data(), payload.size(), ids.data(), ids.size()));
+              });
+
+    std::vector<uint32_t> ids32(ids.size());
+    suite.add("decodeVarints<uint32_t> x4096", payload.size(), ids.size(),
+              [payload, ids32]() mutable {
+                  doNotOptimize(esb::decodeVarints(payload.data(), payload.size(), ids32.data(),
+                                                   ids32.size()));
+              });
+}
+
+void addStringCases(Suite& suite) {
+    for (size_t length : {8, 64, 1024, 32768}) {
+        std::string str(length, 'x');
+        size_t      count = length < 1024 ? kFieldCount : 4;
+
+        addValueCases(suite, "string " + std::to_string(length), str, count);
+
+        auto payload = serializeRepeated(str, count);
+        suite.add("read<string_view " + std::to_string(length) + ">/BufferReader", payload.size(),
+                  count, [payload, count] {
+                      esb::BufferReader reader{payload.data(), payload.size()};
+                      for (size_t i = 0; i < count; ++i) {
+                          doNotOptimize(esb::read<std::string_view>(reader));
+                      }
+                  });
+    }
+
+    std::string attachment(32768, 'x');
+    suite.add("write<string 32768>/GatherWriter", attachment.size() + 2, 1,
+              [attachment, writer = esb::GatherWriter{}]() mutable {
+                  writer.reset();
+                  esb::write(writer, attachment, esb::prefix::u16{});
+                  doNotOptimize(writer.iovecs().data());
+              });
+
+    // A truncated packet whose prefix claims the largest possible string.
+    std::string hostile{"\xFF\xFF" "abc", 5};
+    suite.add("read<string> hostile prefix/BufferReader", hostile.size(), 1, [hostile] {
+        esb::BufferReader reader{hostile.data(), hostile.size()};
+        std::string       tmp;
+        esb::read(reader, tmp);
+        doNotOptimize(tmp);
+    });
+
+    addValueCases(suite, "u16string 64", std::u16string(64, u'x'));
+
+    std::string chat = "A typical chat line mostly made of ascii text, with the odd \xC3\xBC.";
+    std::string payload;
+    {
+        esb::BufferWriter writer;
+        esb::write(writer, esb::as_utf16(chat));
+        payload.assign(writer.data(), writer.size());
+    }
+
+    suite.add("read<as_utf16>/BufferReader", payload.size(), 1, [payload] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        std::string       tmp;
+        esb::read(reader, esb::as_utf16(tmp));
+        doNotOptimize(tmp);
+    });
+
+    suite.add("write<as_utf16>/InlineWriter", payload.size(), 1, [chat] {
+        esb::InlineWriter<512> writer;
+        esb::write(writer, esb::as_utf16(chat));
+        doNotOptimize(writer.data());
+    });
+
+    // Cyrillic text, two UTF-8 bytes per letter.
+    std::string cyrillic;
+    for (int i = 0; i < 8; ++i) {
+        cyrillic += "\xD0\xA1\xD0\xBE\xD0\xBE\xD0\xB1\xD1\x89\xD0\xB5\xD0\xBD\xD0\xB8\xD0\xB5 "
+                    "\xD0\xB2\xD1\x87\xD0\xB0\xD1\x82\xD0\xB5. ";
+    }
+    std::string cyrillicPayload;
+    {
+        esb::BufferWriter writer;
+        esb::write(writer, esb::as_utf16(cyrillic));
+        cyrillicPayload.assign(writer.data(), writer.size());
+    }
+
+    suite.add("read<as_utf16> cyrillic/BufferReader", cyrillicPayload.size(), 1,
+              [cyrillicPayload] {
+                  esb::BufferReader reader{cyrillicPayload.data(), cyrillicPayload.size()};
+                  std::string       tmp;
+                  esb::read(reader, esb::as_utf16(tmp));
+                  doNotOptimize(tmp);
+              });
+
+    suite.add("write<as_utf16> cyrillic/InlineWriter", cyrillicPayload.size(), 1, [cyrillic] {
+        esb::InlineWriter<1024> writer;
+        esb::write(writer, esb::as_utf16(cyrillic));
+        doNotOptimize(writer.data());
+    });
+}
+
+void addContainerCases(Suite& suite) {
+    std::vector<uint16_t> heightMap(4096);
+    for (size_t i = 0; i < heightMap.size(); ++i) {
+        heightMap[i] = static_cast<uint16_t>(i);
+    }
+
+    addValueCases(suite, "vector<uint16_t> 4096", heightMap, 1);
+
+    auto payload = serializeRepeated(heightMap, 1);
+    suite.add("write<uint16_t> loop x4096/BufferWriter", payload.size(), heightMap.size(),
+              [heightMap] {
+                  esb::BufferWriter writer;
+                  esb::write(writer, static_cast<uint32_t>(heightMap.size()));
+                  for (auto height : heightMap) {
+                      esb::write(writer, height);
+                  }
+                  doNotOptimize(writer.data());
+              });
+
+    esb::BufferWriter writer;
+    esb::write(writer, heightMap, esb::big_endian{});
+    std::string bigEndian{writer.data(), writer.size()};
+
+    suite.add("read<vector<uint16_t> 4096,big_endian>/BufferReader", bigEndian.size(),
+              heightMap.size(), [bigEndian] {
+                  esb::BufferReader     reader{bigEndian.data(), bigEndian.size()};
+                  std::vector<uint16_t> tmp;
+                  esb::read(reader, tmp, esb::big_endian{});
+                  doNotOptimize(tmp);
+              });
+}
+
+void addStructCases(Suite& suite) {
+    PositionUpdate update{42, 1.f, 2.f, 3.f, 90};
+    addValueCases(suite, "PositionUpdate", update);
+    addValueCases(suite, "vector<PositionUpdate> 256", std::vector<PositionUpdate>(256, update), 1);
+    addValueCases(suite, "WirePositionUpdate", WirePositionUpdate{42, 1.f, 2.f, 3.f, 90});
+    addValueCases(suite, "vector<WirePositionUpdate> 256",
+                  std::vector<WirePositionUpdate>(256, {42, 1.f, 2.f, 3.f, 90}), 1);
+
+    std::vector<PositionUpdate> updates(256, update);
+    suite.add("write<vector<PositionUpdate> 256>/BufferWriter presized",
+              esb::serialized_size(updates), 1, [updates] {
+                  esb::BufferWriter writer{esb::serialized_size(updates)};
+                  esb::write(writer, updates);
+                  doNotOptimize(writer.data());
+              });
+
+    auto packet = serializeRepeated(updates, 1);
+    suite.add("tryRead<vector<PositionUpdate> 256>/BufferReader", packet.size(), 1, [packet] {
+        esb::BufferReader           reader{packet.data(), packet.size()};
+        std::vector<PositionUpdate> tmp;
+        doNotOptimize(esb::tryRead(reader, tmp));
+        doNotOptimize(tmp);
+    });
+
+    suite.add("validate+read<vector<PositionUpdate> 256>/BufferReader", packet.size(), 1,
+              [packet] {
+                  esb::BufferReader           reader{packet.data(), packet.size()};
+                  std::vector<PositionUpdate> tmp;
+                  if (esb::validate<std::vector<PositionUpdate>>(reader) == esb::errc::ok) {
+                      esb::read(reader, tmp);
+                  }
+                  doNotOptimize(tmp);
+              });
+
+    auto payload = serializeRepeated(update, kFieldCount);
+    suite.add("write<PositionUpdate> by hand/InlineWriter", payload.size(), kFieldCount, [update] {
+        esb::InlineWriter<kInlineCapacity> writer;
+        for (size_t i = 0; i < kFieldCount; ++i) {
+            esb::write(writer, update.id);
+            esb::write(writer, update.x);
+            esb::write(writer, update.y);
+            esb::write(writer, update.z);
+            esb::write(writer, update.heading);
+        }
+        doNotOptimize(writer.data());
+    });
+}
+
+void addArenaCases(Suite& suite) {
+    std::vector<std::string> items(32, "an item name beyond the small string size");
+    auto                     payload = serializeRepeated(items, 1);
+
+    suite.add("read<vector<string> 32>/BufferReader", payload.size(), items.size(), [payload] {
+        esb::BufferReader        reader{payload.data(), payload.size()};
+        std::vector<std::string> tmp;
+        esb::read(reader, tmp);
+        doNotOptimize(tmp);
+    });
+
+    suite.add("read<vector<string> 32>/BufferReader reused", payload.size(), items.size(),
+              [payload, tmp = std::vector<std::string>{}]() mutable {
+                  esb::BufferReader reader{payload.data(), payload.size()};
+                  esb::read(reader, tmp);
+                  doNotOptimize(tmp);
+              });
+
+    suite.add("read<pmr::vector<pmr::string> 32>/BufferReader monotonic", payload.size(),
+              items.size(), [payload] {
+                  char                                buffer[8192];
+                  std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer)};
+                  esb::BufferReader                   reader{payload.data(), payload.size()};
+                  std::pmr::vector<std::pmr::string>  tmp{&arena};
+                  esb::read(reader, tmp);
+                  doNotOptimize(tmp);
+              });
+}
+
+void addSegmentedCases(Suite& suite) {
+    PositionUpdate              update{42, 1.f, 2.f, 3.f, 90};
+    std::vector<PositionUpdate> updates(1024, update);
+    auto payload = std::make_shared<const std::string>(serializeRepeated(updates, 1));
+
+    // Simulate 4 KiB receive buffers, leaving most values within a single segment. The cases share
+    // ownership of the payload so that the segments stay valid.
+    std::vector<std::string_view> segments;
+    for (size_t i = 0; i < payload->size(); i += 4096) {
+        segments.emplace_back(payload->data() + i, std::min<size_t>(4096, payload->size() - i));
+    }
+
+    suite.add("read<vector<PositionUpdate> 1024>/stitched stringstream", payload->size(), 1,
+              [payload, segments] {
+                  std::string stitched;
+                  for (auto segment : segments) {
+                      stitched += segment;
+                  }
+                  std::stringstream ss(stitched, std::ios_base::in | std::ios_base::binary);
+                  std::vector<PositionUpdate> tmp;
+                  esb::read(ss, tmp);
+                  doNotOptimize(tmp);
+              });
+
+    suite.add("read<vector<PositionUpdate> 1024>/SegmentedReader", payload->size(), 1,
+              [payload, segments] {
+                  esb::SegmentedReader        reader{segments};
+                  std::vector<PositionUpdate> tmp;
+                  esb::read(reader, tmp);
+                  doNotOptimize(tmp);
+              });
+}
+
+void addMappedFileCases(Suite& suite) {
+    std::vector<PositionUpdate> updates(65536, PositionUpdate{42, 1.f, 2.f, 3.f, 90});
+    {
+        std::ofstream file(snapshotPath(), std::ios_base::out | std::ios_base::binary);
+        esb::write(file, updates);
+    }
+
+    auto bytes = esb::serialized_size(updates);
+
+    suite.add("read<vector<PositionUpdate> 65536>/ifstream", bytes, 1, [] {
+        std::ifstream               file(snapshotPath(), std::ios_base::in | std::ios_base::binary);
+        std::vector<PositionUpdate> tmp;
+        esb::read(file, tmp);
+        doNotOptimize(tmp);
+    });
+
+    suite.add("read<vector<PositionUpdate> 65536>/MappedFileReader", bytes, 1, [] {
+        esb::MappedFileReader reader{snapshotPath().c_str()};
+        reader.advise(esb::access_hint::sequential);
+        std::vector<PositionUpdate> tmp;
+        esb::read(reader, tmp);
+        doNotOptimize(tmp);
+    });
+}
+
+void addFramingCases(Suite& suite) {
+    using DatagramWriter = esb::InlineWriter<1400>;
+
+    PositionUpdate update{42, 1.f, 2.f, 3.f, 90};
+    auto frameBytes = esb::frame_header_size<uint16_t, uint16_t>() + esb::serialized_size(update);
+    auto bytes      = 32 * frameBytes;
+
+    suite.add("FrameWriter 32 x PositionUpdate/InlineWriter", bytes, 32, [update] {
+        DatagramWriter                   writer;
+        esb::FrameWriter<DatagramWriter> frames{writer};
+        for (uint16_t i = 0; i < 32; ++i) {
+            frames.write(i, update);
+        }
+        doNotOptimize(writer);
+    });
+
+    DatagramWriter                   datagram;
+    esb::FrameWriter<DatagramWriter> frames{datagram};
+    for (uint16_t i = 0; i < 32; ++i) {
+        frames.write(i, update);
+    }
+    std::string payload(datagram.data(), datagram.size());
+
+    suite.add("FrameReader 32 x PositionUpdate/BufferReader", bytes, 32, [payload] {
+        esb::FrameReader<> received{payload};
+        for (auto frame : received) {
+            doNotOptimize(esb::read<PositionUpdate>(frame.body));
+        }
+    });
+}
+
+template <size_t I>
+struct OpcodeMessage {
+    static constexpr uint32_t opcode = esb::crc32("OpcodeMessage") ^ (I * 0x9E3779B9u);
+
+    uint32_t value;
+
+    ESB_FIELDS(value)
+};
+
+using OpcodeHandlers = std::unordered_map<uint32_t, std::function<void(esb::BufferReader&)>>;
+
+// Baseline dispatch through a hash map of type-erased handlers decoding into reused objects.
+template <size_t... Is>
+struct OpcodeMap {
+    std::tuple<OpcodeMessage<Is>...> messages;
+    OpcodeHandlers                   handlers;
+
+    OpcodeMap() {
+        ((handlers[OpcodeMessage<Is>::opcode] =
+              [this](esb::BufferReader& reader) {
+                  auto& msg = std::get<OpcodeMessage<Is>>(messages);
+                  esb::read(reader, msg);
+                  doNotOptimize(msg);
+              }),
+         ...);
+    }
+};
+
+template <size_t... Is>
+OpcodeMap<Is...> makeOpcodeMap(std::index_sequence<Is...>);
+
+template <size_t... Is>
+esb::Dispatcher<OpcodeMessage<Is>...> makeDispatcher(std::index_sequence<Is...>);
+
+void addDispatchCases(Suite& suite) {
+    using Types      = std::make_index_sequence<32>;
+    using Map        = decltype(makeOpcodeMap(Types{}));
+    using Dispatcher = decltype(makeDispatcher(Types{}));
+
+    const uint32_t opcodes[] = {OpcodeMessage<0>::opcode,  OpcodeMessage<7>::opcode,
+                                OpcodeMessage<19>::opcode, OpcodeMessage<3>::opcode,
+                                OpcodeMessage<31>::opcode, OpcodeMessage<12>::opcode,
+                                OpcodeMessage<25>::opcode, OpcodeMessage<8>::opcode};
+
+    esb::BufferWriter writer;
+    for (uint32_t i = 0; i < 64; ++i) {
+        esb::write(writer, opcodes[i % 8]);
+        esb::write(writer, i);
+    }
+    std::string payload(writer.data(), writer.size());
+
+    auto map = std::make_shared<Map>();
+    suite.add("dispatch 64 messages/unordered_map", payload.size(), 64, [payload, map] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        while (reader.remaining() != 0) {
+            map->handlers.find(esb::read<uint32_t>(reader))->second(reader);
+        }
+    });
+
+    auto dispatcher = std::make_shared<Dispatcher>();
+    suite.add("dispatch 64 messages/Dispatcher", payload.size(), 64, [payload, dispatcher] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        while (reader.remaining() != 0) {
+            dispatcher->dispatch(reader, [](const auto& msg) { doNotOptimize(msg); });
+        }
+    });
+}
+
+// A large message received in MTU sized chunks, either collected until complete and then read,
+// or decoded as each chunk arrives.
+void addIncrementalCases(Suite& suite) {
+    using Updates = std::vector<PositionUpdate>;
+
+    Updates updates(4096, PositionUpdate{42, 1.f, 2.f, 3.f, 90});
+    auto    payload = serializeRepeated(updates, 1);
+
+    suite.add("read<vector<PositionUpdate> 4096>/chunked buffered", payload.size(), 1,
+              [payload, buffer = std::string{}, tmp = Updates{}]() mutable {
+                  buffer.clear();
+                  for (size_t fed = 0; fed < payload.size(); fed += 1400) {
+                      buffer.append(payload, fed, 1400);
+                  }
+                  esb::BufferReader reader{buffer.data(), buffer.size()};
+                  esb::read(reader, tmp);
+                  doNotOptimize(tmp);
+              });
+
+    suite.add("read<vector<PositionUpdate> 4096>/chunked IncrementalDecoder", payload.size(), 1,
+              [payload, decoder = esb::IncrementalDecoder<Updates>{}]() mutable {
+                  decoder.reset();
+                  for (size_t fed = 0; fed < payload.size(); fed += 1400) {
+                      auto size = payload.size() - fed < 1400 ? payload.size() - fed : 1400;
+                      decoder.feed(payload.data() + fed, size);
+                  }
+                  doNotOptimize(decoder.value());
+              });
+}
+
+void addPositionalCases(Suite& suite) {
+    auto payload = serializeRepeated(uint32_t{0xDEADBEEF}, kFieldCount);
+    auto ss =
+        std::make_shared<std::stringstream>(payload, std::ios_base::in | std::ios_base::binary);
+
+    suite.add("peekAt<uint32_t>/stringstream", sizeof(uint32_t), 1, [ss] {
+        ss->clear();
+        ss->seekg(0);
+        doNotOptimize(esb::peekAt<uint32_t>(*ss, 8));
+    });
+
+    suite.add("peekAt<uint32_t>/BufferReader", sizeof(uint32_t), 1, [payload] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        doNotOptimize(esb::peekAt<uint32_t>(reader, 8));
+    });
+
+    suite.add("readAt<uint32_t>/stringstream", sizeof(uint32_t), 1, [ss] {
+        ss->clear();
+        ss->seekg(0);
+        doNotOptimize(esb::readAt<uint32_t>(*ss, 8));
+    });
+
+    suite.add("readAt<uint32_t>/BufferReader", sizeof(uint32_t), 1, [payload] {
+        esb::BufferReader reader{payload.data(), payload.size()};
+        doNotOptimize(esb::readAt<uint32_t>(reader, 8));
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Suite suite;
+
+    addIntegralCases(suite);
+    addVarintCases(suite);
+    addStringCases(suite);
+    addContainerCases(suite);
+    addStructCases(suite);
+    addArenaCases(suite);
+    addSegmentedCases(suite);
+    addMappedFileCases(suite);
+    addFramingCases(suite);
+    addDispatchCases(suite);
+    addIncrementalCases(suite);
+    addPositionalCases(suite);
+
+    int status = suite.run(argc, argv);
+    std::remove(snapshotPath().c_str());
+    return status;
+}
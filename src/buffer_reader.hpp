@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <string_view>
+
+namespace esb {
+
+// Read-only stream over a contiguous block of memory. Provides the subset of the std::istream
+// interface used by the esb::read family (read, seekg, tellg and state queries) without the
+// sentry, locale and virtual dispatch overhead of the standard streams. The reader does not own
+// the underlying bytes, which must outlive it.
+class BufferReader {
+public:
+    using positional_view = void;
+
+    BufferReader() = default;
+
+    BufferReader(const std::byte* data, size_t size)
+        : data_{reinterpret_cast<const char*>(data)}
+        , size_{size} {}
+
+    BufferReader(const char* data, size_t size)
+        : data_{data}
+        , size_{size} {}
+
+    explicit BufferReader(std::string_view data)
+        : data_{data.data()}
+        , size_{data.size()} {}
+
+    BufferReader& read(char* dst, std::streamsize count) {
+        auto length = static_cast<size_t>(count);
+
+        if (length <= size_ - pos_) {
+            // Empty reads, e.g. of an empty vector, may pass a null destination.
+            if (length > 0) {
+                std::memcpy(dst, data_ + pos_, length);
+            }
+            pos_ += length;
+            gcount_ = count;
+        } else {
+            // Mirror std::istream: hand over whatever is left and flag the short read.
+            if (pos_ < size_) {
+                std::memcpy(dst, data_ + pos_, size_ - pos_);
+            }
+
+            gcount_ = static_cast<std::streamsize>(size_ - pos_);
+            pos_    = size_;
+            state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+        }
+
+        return *this;
+    }
+
+    // Returns a pointer to the next count bytes of the buffer and advances past them, or nullptr
+    // (flagging the short read) if fewer than count bytes remain.
+    const char* consume(size_t count) {
+        if (count > size_ - pos_) {
+            pos_ = size_;
+            state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+            return nullptr;
+        }
+
+        auto ptr = data_ + pos_;
+        pos_ += count;
+        return ptr;
+    }
+
+    std::streampos tellg() const {
+        return fail() ? std::streampos(-1) : std::streampos(static_cast<std::streamoff>(pos_));
+    }
+
+    BufferReader& seekg(std::streampos pos) {
+        return seekg(static_cast<std::streamoff>(pos), std::ios_base::beg);
+    }
+
+    BufferReader& seekg(std::streamoff offset, std::ios_base::seekdir dir) {
+        state_ &= ~std::ios_base::eofbit;
+
+        if (fail()) {
+            return *this;
+        }
+
+        std::streamoff base = 0;
+        if (dir == std::ios_base::cur) {
+            base = static_cast<std::streamoff>(pos_);
+        } else if (dir == std::ios_base::end) {
+            base = static_cast<std::streamoff>(size_);
+        }
+
+        auto target = base + offset;
+        if (target < 0 || target > static_cast<std::streamoff>(size_)) {
+            state_ |= std::ios_base::failbit;
+        } else {
+            pos_ = static_cast<size_t>(target);
+        }
+
+        return *this;
+    }
+
+    std::streamsize gcount() const { return gcount_; }
+
+    std::ios_base::iostate rdstate() const { return state_; }
+    void setstate(std::ios_base::iostate state) { state_ |= state; }
+    void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+
+    bool good() const { return state_ == std::ios_base::goodbit; }
+    bool eof() const { return (state_ & std::ios_base::eofbit) != 0; }
+    bool fail() const { return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0; }
+    explicit operator bool() const { return !fail(); }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t position() const { return pos_; }
+    size_t remaining() const { return size_ - pos_; }
+
+private:
+    const char*            data_   = nullptr;
+    size_t                 size_   = 0;
+    size_t                 pos_    = 0;
+    std::streamsize        gcount_ = 0;
+    std::ios_base::iostate state_  = std::ios_base::goodbit;
+};
+
+}  // namespace esb
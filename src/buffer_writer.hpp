@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <vector>
+
+namespace esb {
+
+// Write-only stream that accumulates output in a contiguous, geometrically growing byte vector.
+// Provides the subset of the std::ostream interface used by the esb::write family. Unlike
+// std::ostringstream::str(), the accumulated bytes can be inspected in place via data()/size() or
+// handed off without copying via release().
+class BufferWriter {
+public:
+    BufferWriter() = default;
+
+    explicit BufferWriter(size_t capacity) { buffer_.reserve(capacity); }
+
+    // Adopts existing storage, reusing its capacity for subsequent writes.
+    explicit BufferWriter(std::vector<char> storage)
+        : buffer_{std::move(storage)} {
+        buffer_.clear();
+    }
+
+    BufferWriter& write(const char* src, std::streamsize count) {
+        // Like the standard streams, a failed writer ignores further output, so a message abandoned
+        // part way, e.g. over an oversize string, leaves no bytes of what followed.
+        auto length = static_cast<size_t>(count);
+        if (fail() || length == 0) {
+            return *this;
+        }
+
+        // Overwrite whatever lies past a seek, then append the rest without zero filling it first.
+        auto overwrite = buffer_.size() - pos_ < length ? buffer_.size() - pos_ : length;
+        if (overwrite > 0) {
+            std::memcpy(buffer_.data() + pos_, src, overwrite);
+        }
+
+        buffer_.insert(buffer_.end(), src + overwrite, src + length);
+
+        pos_ += length;
+        return *this;
+    }
+
+    std::streampos tellp() const {
+        return fail() ? std::streampos(-1) : std::streampos(static_cast<std::streamoff>(pos_));
+    }
+
+    BufferWriter& seekp(std::streampos pos) {
+        return seekp(static_cast<std::streamoff>(pos), std::ios_base::beg);
+    }
+
+    BufferWriter& seekp(std::streamoff offset, std::ios_base::seekdir dir) {
+        if (fail()) {
+            return *this;
+        }
+
+        std::streamoff base = 0;
+        if (dir == std::ios_base::cur) {
+            base = static_cast<std::streamoff>(pos_);
+        } else if (dir == std::ios_base::end) {
+            base = static_cast<std::streamoff>(buffer_.size());
+        }
+
+        auto target = base + offset;
+        if (target < 0 || target > static_cast<std::streamoff>(buffer_.size())) {
+            state_ |= std::ios_base::failbit;
+        } else {
+            pos_ = static_cast<size_t>(target);
+        }
+
+        return *this;
+    }
+
+    BufferWriter& flush() { return *this; }
+
+    std::ios_base::iostate rdstate() const { return state_; }
+    void setstate(std::ios_base::iostate state) { state_ |= state; }
+    void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+
+    bool good() const { return state_ == std::ios_base::goodbit; }
+    bool fail() const { return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0; }
+    explicit operator bool() const { return !fail(); }
+
+    void reserve(size_t capacity) { buffer_.reserve(capacity); }
+
+    // Discards the written bytes while keeping the allocated capacity.
+    void reset() {
+        buffer_.clear();
+        pos_   = 0;
+        state_ = std::ios_base::goodbit;
+    }
+
+    // Hands the written bytes over to the caller without copying and leaves the writer empty.
+    std::vector<char> release() {
+        std::vector<char> tmp;
+        tmp.swap(buffer_);
+        pos_ = 0;
+        return tmp;
+    }
+
+    char*       data() { return buffer_.data(); }
+    const char* data() const { return buffer_.data(); }
+    size_t      size() const { return buffer_.size(); }
+    size_t      capacity() const { return buffer_.capacity(); }
+
+private:
+    std::vector<char>      buffer_;
+    size_t                 pos_   = 0;
+    std::ios_base::iostate state_ = std::ios_base::goodbit;
+};
+
+}  // namespace esb
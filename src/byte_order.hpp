@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace esb {
+
+// Byte order policies. A policy can be selected for a single call by passing it as the trailing
+// argument of read/write, or for every call on a stream by declaring it as a nested byte_order
+// type on the stream:
+//
+//     struct SessionReader : esb::BufferReader {
+//         using byte_order = esb::big_endian;
+//         using BufferReader::BufferReader;
+//     };
+struct little_endian {};
+struct big_endian {};
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && \
+    __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+using native = big_endian;
+#else
+using native = little_endian;
+#endif
+
+template <typename T>
+struct is_byte_order : std::integral_constant<bool, std::is_same<T, little_endian>::value ||
+                                                        std::is_same<T, big_endian>::value> {};
+
+template <typename StreamT, typename = void>
+struct byte_order_of {
+    using type = native;
+};
+
+template <typename StreamT>
+struct byte_order_of<StreamT, std::void_t<typename StreamT::byte_order>> {
+    using type = typename StreamT::byte_order;
+};
+
+template <typename StreamT>
+using byte_order_t = typename byte_order_of<StreamT>::type;
+
+template <typename Order>
+struct needs_byte_swap : std::integral_constant<bool, !std::is_same<Order, native>::value> {};
+
+namespace detail {
+
+inline uint16_t byteSwap(uint16_t val) {
+#if defined(_MSC_VER)
+    return _byteswap_ushort(val);
+#else
+    return __builtin_bswap16(val);
+#endif
+}
+
+inline uint32_t byteSwap(uint32_t val) {
+#if defined(_MSC_VER)
+    return _byteswap_ulong(val);
+#else
+    return __builtin_bswap32(val);
+#endif
+}
+
+inline uint64_t byteSwap(uint64_t val) {
+#if defined(_MSC_VER)
+    return _byteswap_uint64(val);
+#else
+    return __builtin_bswap64(val);
+#endif
+}
+
+template <size_t Width>
+struct swap_word;
+
+template <>
+struct swap_word<2> {
+    using type = uint16_t;
+};
+
+template <>
+struct swap_word<4> {
+    using type = uint32_t;
+};
+
+template <>
+struct swap_word<8> {
+    using type = uint64_t;
+};
+
+// Reverses the bytes of any 1, 2, 4 or 8 byte arithmetic or enum value.
+template <typename T>
+T byteSwapValue(T val) {
+    if constexpr (sizeof(T) == 1) {
+        return val;
+    } else {
+        typename swap_word<sizeof(T)>::type bits;
+        std::memcpy(&bits, &val, sizeof(T));
+        bits = byteSwap(bits);
+        std::memcpy(&val, &bits, sizeof(T));
+        return val;
+    }
+}
+
+#if defined(__SSSE3__)
+template <size_t Width>
+inline __m128i byteSwapMask128() {
+    if constexpr (Width == 2) {
+        return _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    } else if constexpr (Width == 4) {
+        return _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    } else {
+        return _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    }
+}
+#endif
+
+// Reverses the bytes of each of the `count` Width-byte elements stored at data. Uses 32 byte
+// AVX2 or 16 byte SSSE3 shuffles when the target supports them, finishing with scalar swaps.
+template <size_t Width>
+void byteSwapSequence(char* data, size_t count) {
+    if constexpr (Width > 1) {
+        size_t bytes = count * Width;
+        size_t i     = 0;
+
+#if defined(__AVX2__)
+        const __m256i mask256 = _mm256_broadcastsi128_si256(byteSwapMask128<Width>());
+        for (; i + 32 <= bytes; i += 32) {
+            auto ptr = reinterpret_cast<__m256i*>(data + i);
+            _mm256_storeu_si256(ptr, _mm256_shuffle_epi8(_mm256_loadu_si256(ptr), mask256));
+        }
+#endif
+
+#if defined(__SSSE3__)
+        const __m128i mask128 = byteSwapMask128<Width>();
+        for (; i + 16 <= bytes; i += 16) {
+            auto ptr = reinterpret_cast<__m128i*>(data + i);
+            _mm_storeu_si128(ptr, _mm_shuffle_epi8(_mm_loadu_si128(ptr), mask128));
+        }
+#endif
+
+        using word_type = typename swap_word<Width>::type;
+        for (; i < bytes; i += Width) {
+            word_type word;
+            std::memcpy(&word, data + i, Width);
+            word = byteSwap(word);
+            std::memcpy(data + i, &word, Width);
+        }
+    }
+}
+
+}  // namespace detail
+
+}  // namespace esb
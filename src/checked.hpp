@@ -0,0 +1,532 @@
+#pragma once
+
+#include "serialization.hpp"
+#include "unicode.hpp"
+#include "varint.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace esb {
+
+// Reasons a checked read can fail. Checked reads also set failbit on the stream, so that any
+// further reads from it fail as well.
+enum class errc {
+    ok = 0,
+    truncated,        // the input ended in the middle of a value
+    length_overflow,  // a length prefix exceeds length_limit or the bytes left in the input
+    invalid_enum,     // an enum value outside its declared enum_range
+    invalid_value,    // any other malformed value, such as a bool other than 0 or 1
+};
+
+// A decoded value or the reason decoding failed, in the spirit of std::expected.
+template <typename T>
+class result {
+public:
+    result(T value)
+        : value_{std::move(value)} {}
+
+    result(errc error)
+        : error_{error} {}
+
+    explicit operator bool() const { return error_ == errc::ok; }
+    bool has_value() const { return error_ == errc::ok; }
+    errc error() const { return error_; }
+
+    T&       value() & { return value_; }
+    const T& value() const& { return value_; }
+    T&&      value() && { return std::move(value_); }
+
+    T&       operator*() & { return value_; }
+    const T& operator*() const& { return value_; }
+    T*       operator->() { return &value_; }
+    const T* operator->() const { return &value_; }
+
+private:
+    T    value_{};
+    errc error_ = errc::ok;
+};
+
+// Declares the valid range of an enum so that checked reads reject values outside it:
+//
+//     template <>
+//     struct esb::enum_range<Opcode> {
+//         static constexpr Opcode min = Opcode::LOGIN;
+//         static constexpr Opcode max = Opcode::CHAT;
+//     };
+//
+// Enums without a declared range accept any value of their underlying type.
+template <typename T>
+struct enum_range {};
+
+template <typename T, typename = void>
+struct has_enum_range : std::false_type {};
+
+template <typename T>
+struct has_enum_range<T, std::void_t<decltype(enum_range<T>::min), decltype(enum_range<T>::max)>>
+    : std::true_type {};
+
+namespace detail {
+
+template <typename T>
+struct is_std_string : std::false_type {};
+
+template <typename Traits, typename Alloc>
+struct is_std_string<std::basic_string<char, Traits, Alloc>> : std::true_type {};
+
+template <typename T>
+struct is_std_u16string : std::false_type {};
+
+template <typename Traits, typename Alloc>
+struct is_std_u16string<std::basic_string<char16_t, Traits, Alloc>> : std::true_type {};
+
+template <typename T>
+struct is_utf16_adapter : std::false_type {};
+
+template <typename StringT>
+struct is_utf16_adapter<utf16_adapter<StringT>> : std::true_type {};
+
+template <typename T>
+struct is_std_vector : std::false_type {};
+
+template <typename T, typename Alloc>
+struct is_std_vector<std::vector<T, Alloc>> : std::true_type {};
+
+// Fixed length arrays, std::array and built-in, whose elements are checked one by one.
+template <typename T>
+struct array_traits {
+    static constexpr bool value = false;
+};
+
+template <typename T, size_t N>
+struct array_traits<std::array<T, N>> {
+    static constexpr bool   value = true;
+    static constexpr size_t size  = N;
+    using element_type            = T;
+};
+
+template <typename T, size_t N>
+struct array_traits<T[N]> {
+    static constexpr bool   value = true;
+    static constexpr size_t size  = N;
+    using element_type            = T;
+};
+
+// Types whose bytes must be inspected to be validated, rather than merely being present.
+template <typename T, typename = void>
+struct needs_value_check
+    : std::integral_constant<bool, std::is_same<T, bool>::value || has_enum_range<T>::value> {};
+
+template <typename FieldList>
+struct any_needs_value_check;
+
+template <typename... Fields>
+struct any_needs_value_check<type_list<Fields...>>
+    : std::integral_constant<bool, (needs_value_check<Fields>::value || ...)> {};
+
+template <typename T>
+struct needs_value_check<T, std::enable_if_t<has_fields<T>::value>>
+    : any_needs_value_check<field_types_t<T>> {};
+
+template <typename T, size_t N>
+struct needs_value_check<std::array<T, N>> : needs_value_check<T> {};
+
+template <typename T, size_t N>
+struct needs_value_check<T[N]> : needs_value_check<T> {};
+
+// Translates the state of a stream after a read into an error code.
+template <typename StreamT>
+errc streamError(const StreamT& is) {
+    if (!is.fail()) {
+        return errc::ok;
+    }
+
+    return is.eof() ? errc::truncated : errc::invalid_value;
+}
+
+template <typename StreamT>
+errc fail(StreamT& is, errc error) {
+    is.setstate(std::ios_base::failbit);
+    return error;
+}
+
+template <typename T>
+struct uses_stream_checks
+    : std::integral_constant<bool, !std::is_same<T, bool>::value && !std::is_enum<T>::value &&
+                                       !has_fields<T>::value && !is_std_string<T>::value &&
+                                       !is_std_u16string<T>::value &&
+                                       !is_utf16_adapter<T>::value && !is_std_vector<T>::value &&
+                                       !array_traits<T>::value> {};
+
+}  // namespace detail
+
+// Checked reads: each value is decoded with a single check of the outcome, reporting why the input
+// was rejected instead of leaving the caller to inspect the stream state. Length prefixes and
+// element counts are checked against length_limit and, for streams that expose remaining(),
+// against the bytes left before anything is allocated.
+template <typename StreamT, typename T,
+          typename std::enable_if_t<detail::uses_stream_checks<T>::value, int> = 0>
+errc tryRead(StreamT& is, T& val);
+
+template <typename StreamT>
+errc tryRead(StreamT& is, bool& val);
+
+template <typename StreamT, typename T, typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+errc tryRead(StreamT& is, T& val);
+
+template <typename StreamT, typename Traits, typename Alloc, typename Prefix,
+          typename std::enable_if_t<is_length_prefix<Prefix>::value, int> = 0>
+errc tryRead(StreamT& is, std::basic_string<char, Traits, Alloc>& val, Prefix prefix);
+
+template <typename StreamT, typename Traits, typename Alloc>
+errc tryRead(StreamT& is, std::basic_string<char, Traits, Alloc>& val);
+
+template <typename StreamT, typename Traits, typename Alloc>
+errc tryRead(StreamT& is, std::basic_string<char16_t, Traits, Alloc>& val);
+
+template <typename StreamT, typename StringT,
+          typename std::enable_if_t<!std::is_const<StringT>::value, int> = 0>
+errc tryRead(StreamT& is, utf16_adapter<StringT> val);
+
+template <typename StreamT, typename T, typename Alloc>
+errc tryRead(StreamT& is, std::vector<T, Alloc>& val);
+
+template <typename StreamT, typename T, size_t N>
+errc tryRead(StreamT& is, std::array<T, N>& val);
+
+template <typename StreamT, typename T, size_t N>
+errc tryRead(StreamT& is, T (&val)[N]);
+
+template <typename StreamT, typename T, typename std::enable_if_t<has_fields<T>::value, int> = 0>
+errc tryRead(StreamT& is, T& val);
+
+template <typename StreamT, typename T,
+          typename std::enable_if_t<detail::uses_stream_checks<T>::value, int>>
+errc tryRead(StreamT& is, T& val) {
+    read(is, val);
+    return detail::streamError(is);
+}
+
+template <typename StreamT>
+errc tryRead(StreamT& is, bool& val) {
+    uint8_t byte = 0;
+    read(is, byte);
+
+    if (is.fail()) {
+        return detail::streamError(is);
+    }
+
+    if (byte > 1) {
+        return detail::fail(is, errc::invalid_value);
+    }
+
+    val = byte != 0;
+    return errc::ok;
+}
+
+template <typename StreamT, typename T, typename std::enable_if_t<std::is_enum<T>::value, int>>
+errc tryRead(StreamT& is, T& val) {
+    T tmp{};
+    read(is, tmp);
+
+    if (is.fail()) {
+        return detail::streamError(is);
+    }
+
+    if constexpr (has_enum_range<T>::value) {
+        using underlying = std::underlying_type_t<T>;
+
+        auto bits = static_cast<underlying>(tmp);
+        if (bits < static_cast<underlying>(enum_range<T>::min) ||
+            bits > static_cast<underlying>(enum_range<T>::max)) {
+            return detail::fail(is, errc::invalid_enum);
+        }
+    }
+
+    val = tmp;
+    return errc::ok;
+}
+
+template <typename StreamT, typename Traits, typename Alloc, typename Prefix,
+          typename std::enable_if_t<is_length_prefix<Prefix>::value, int>>
+errc tryRead(StreamT& is, std::basic_string<char, Traits, Alloc>& val, Prefix prefix) {
+    auto length = detail::readLength(is, prefix);
+
+    if (is.fail()) {
+        return detail::streamError(is);
+    }
+
+    if (!detail::checkLength(is, length, 1, length_limit_of<StreamT>::value)) {
+        return errc::length_overflow;
+    }
+
+    detail::readResized(is, val, length, [&is, &val](size_t offset, size_t count) {
+        is.read(val.data() + offset, static_cast<std::streamsize>(count));
+        return !is.fail();
+    });
+
+    return detail::streamError(is);
+}
+
+template <typename StreamT, typename Traits, typename Alloc>
+errc tryRead(StreamT& is, std::basic_string<char, Traits, Alloc>& val) {
+    return tryRead(is, val, length_prefix_t<StreamT>{});
+}
+
+namespace detail {
+
+// Reads a uint32_t count of UTF-16 code units and checks it against the input.
+template <typename StreamT>
+errc tryReadUtf16Count(StreamT& is, uint32_t& count) {
+    read(is, count);
+
+    if (is.fail()) {
+        return streamError(is);
+    }
+
+    if (!checkLength(is, count, sizeof(char16_t), length_limit_of<StreamT>::value)) {
+        return errc::length_overflow;
+    }
+
+    return errc::ok;
+}
+
+}  // namespace detail
+
+template <typename StreamT, typename Traits, typename Alloc>
+errc tryRead(StreamT& is, std::basic_string<char16_t, Traits, Alloc>& val) {
+    uint32_t count = 0;
+    if (auto error = detail::tryReadUtf16Count(is, count); error != errc::ok) {
+        return error;
+    }
+
+    detail::readResized(is, val, count, [&is, &val](size_t offset, size_t n) {
+        detail::readSequence(is, val.data() + offset, n, byte_order_t<StreamT>{});
+        return !is.fail();
+    });
+
+    return detail::streamError(is);
+}
+
+// Malformed UTF-16 is reported as invalid_value.
+template <typename StreamT, typename StringT,
+          typename std::enable_if_t<!std::is_const<StringT>::value, int>>
+errc tryRead(StreamT& is, utf16_adapter<StringT> val) {
+    uint32_t count = 0;
+    if (auto error = detail::tryReadUtf16Count(is, count); error != errc::ok) {
+        return error;
+    }
+
+    detail::readUtf16(is, val.value, count);
+
+    return detail::streamError(is);
+}
+
+template <typename StreamT, typename T, typename Alloc>
+errc tryRead(StreamT& is, std::vector<T, Alloc>& val) {
+    static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not supported");
+
+    uint32_t length = 0;
+    read(is, length);
+
+    if (is.fail()) {
+        return detail::streamError(is);
+    }
+
+    if (!detail::checkLength(is, length, detail::minSerializedSize<T, StreamT>(),
+                             length_limit_of<StreamT>::value)) {
+        return errc::length_overflow;
+    }
+
+    if constexpr (is_bulk_serializable<T>::value && !detail::needs_value_check<T>::value) {
+        detail::readResized(is, val, length, [&is, &val](size_t offset, size_t count) {
+            detail::readSequence(is, val.data() + offset, count, byte_order_t<StreamT>{});
+            return !is.fail();
+        });
+        return detail::streamError(is);
+    } else if constexpr (is_fixed_size<T>::value) {
+        auto error = errc::ok;
+        detail::readResized(is, val, length, [&is, &val, &error](size_t offset, size_t count) {
+            for (size_t i = offset; i < offset + count && error == errc::ok; ++i) {
+                error = tryRead(is, val[i]);
+            }
+            return error == errc::ok;
+        });
+        return error;
+    } else {
+        // As with read, elements are only created as they are reached.
+        if (length < val.size()) {
+            val.resize(length);
+        }
+
+        for (uint32_t i = 0; i < length; ++i) {
+            if (i == val.size()) {
+                val.resize(i + 1);
+            }
+
+            if (auto error = tryRead(is, val[i]); error != errc::ok) {
+                return error;
+            }
+        }
+        return errc::ok;
+    }
+}
+
+namespace detail {
+
+// Arrays of elements that need no checks of their own are read in one go; the rest element by
+// element, so that every bool, ranged enum and length prefix is checked.
+template <typename StreamT, typename T, size_t N, typename ArrayT>
+errc tryReadArray(StreamT& is, ArrayT& val) {
+    if constexpr (uses_stream_checks<T>::value) {
+        read(is, val);
+        return streamError(is);
+    } else {
+        for (size_t i = 0; i < N; ++i) {
+            if (auto error = tryRead(is, val[i]); error != errc::ok) {
+                return error;
+            }
+        }
+        return errc::ok;
+    }
+}
+
+}  // namespace detail
+
+template <typename StreamT, typename T, size_t N>
+errc tryRead(StreamT& is, std::array<T, N>& val) {
+    return detail::tryReadArray<StreamT, T, N>(is, val);
+}
+
+template <typename StreamT, typename T, size_t N>
+errc tryRead(StreamT& is, T (&val)[N]) {
+    return detail::tryReadArray<StreamT, T, N>(is, val);
+}
+
+template <typename StreamT, typename T, typename std::enable_if_t<has_fields<T>::value, int>>
+errc tryRead(StreamT& is, T& val) {
+    if constexpr (detail::is_raw_copyable<T, byte_order_t<StreamT>>::value &&
+                  !detail::needs_value_check<T>::value) {
+        detail::readSequence(is, &val, 1, byte_order_t<StreamT>{});
+        return detail::streamError(is);
+    } else {
+        auto error = errc::ok;
+        val.esbVisitFields([&is, &error](auto&... fields) {
+            (void)(((error = tryRead(is, fields)) == errc::ok) && ...);
+        });
+        return error;
+    }
+}
+
+template <typename T, typename StreamT>
+result<T> tryRead(StreamT& is) {
+    T tmp{};
+    if (auto error = tryRead(is, tmp); error != errc::ok) {
+        return error;
+    }
+    return tmp;
+}
+
+namespace detail {
+
+template <typename StreamT, typename... Fields>
+errc validateFields(StreamT& is, type_list<Fields...>);
+
+// Walks a serialized T on a contiguous stream without materializing it, checking that every
+// length prefix fits within the input and that every bool and ranged enum holds a valid value.
+template <typename T, typename StreamT>
+errc validateValue(StreamT& is) {
+    if constexpr (is_fixed_size<T>::value && !needs_value_check<T>::value) {
+        return is.consume(fixed_serialized_size<T>::value) ? errc::ok : errc::truncated;
+    } else if constexpr (is_std_string<T>::value) {
+        auto length = readLength(is, length_prefix_t<StreamT>{});
+
+        if (is.fail()) {
+            return streamError(is);
+        }
+
+        if (length > length_limit_of<StreamT>::value) {
+            return errc::length_overflow;
+        }
+
+        return is.consume(length) ? errc::ok : errc::length_overflow;
+    } else if constexpr (is_std_u16string<T>::value) {
+        uint32_t count = 0;
+        if (auto error = tryReadUtf16Count(is, count); error != errc::ok) {
+            return error;
+        }
+
+        return is.consume(count * sizeof(char16_t)) ? errc::ok : errc::length_overflow;
+    } else if constexpr (is_std_vector<T>::value) {
+        using element_type = typename T::value_type;
+
+        uint32_t length = 0;
+        read(is, length);
+
+        if (is.fail()) {
+            return streamError(is);
+        }
+
+        if (!checkLength(is, length, minSerializedSize<element_type, StreamT>(),
+                         length_limit_of<StreamT>::value)) {
+            return errc::length_overflow;
+        }
+
+        if constexpr (is_fixed_size<element_type>::value &&
+                      !needs_value_check<element_type>::value) {
+            return is.consume(length * fixed_serialized_size<element_type>::value)
+                       ? errc::ok
+                       : errc::length_overflow;
+        } else {
+            for (uint32_t i = 0; i < length; ++i) {
+                if (auto error = validateValue<element_type>(is); error != errc::ok) {
+                    return error;
+                }
+            }
+            return errc::ok;
+        }
+    } else if constexpr (array_traits<T>::value) {
+        for (size_t i = 0; i < array_traits<T>::size; ++i) {
+            if (auto error = validateValue<typename array_traits<T>::element_type>(is);
+                error != errc::ok) {
+                return error;
+            }
+        }
+        return errc::ok;
+    } else if constexpr (has_fields<T>::value) {
+        return validateFields(is, field_types_t<T>{});
+    } else {
+        T tmp{};
+        return tryRead(is, tmp);
+    }
+}
+
+template <typename StreamT, typename... Fields>
+errc validateFields(StreamT& is, type_list<Fields...>) {
+    auto error = errc::ok;
+    (void)(((error = validateValue<Fields>(is)) == errc::ok) && ...);
+    return error;
+}
+
+}  // namespace detail
+
+// Validates a serialized T in a single pass over a contiguous positional stream, leaving the stream
+// itself untouched. Once validation succeeds, the same bytes can be decoded with the unchecked
+// esb::read, whose hot path then carries no per-field error handling. Fixed size types without
+// bools or ranged enums are validated with a single bounds check.
+template <typename T, typename StreamT>
+errc validate(const StreamT& is) {
+    static_assert(is_positional_stream<StreamT>::value && is_contiguous_stream<StreamT>::value,
+                  "validate requires a contiguous positional stream");
+
+    StreamT tmp{is};
+    return detail::validateValue<T>(tmp);
+}
+
+}  // namespace esb
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <ios>
+
+namespace esb {
+
+// Write-only stream that discards its output and only counts it, so that the exact number of bytes
+// a sequence of writes would produce can be measured without allocating. Like any stream it can
+// be derived from to declare byte_order and length_prefix policies, making the count exact for
+// streams that use them:
+//
+//     struct SessionCounter : esb::CountingWriter {
+//         using length_prefix = esb::prefix::u8;
+//     };
+//
+// Seeking is supported so that code which back-patches earlier output measures the same size.
+class CountingWriter {
+public:
+    CountingWriter& write(const char*, std::streamsize count) {
+        // A failed writer ignores further output, like the standard streams.
+        if (fail()) {
+            return *this;
+        }
+
+        pos_ += static_cast<size_t>(count);
+
+        if (pos_ > size_) {
+            size_ = pos_;
+        }
+
+        return *this;
+    }
+
+    std::streampos tellp() const {
+        return fail() ? std::streampos(-1) : std::streampos(static_cast<std::streamoff>(pos_));
+    }
+
+    CountingWriter& seekp(std::streampos pos) {
+        return seekp(static_cast<std::streamoff>(pos), std::ios_base::beg);
+    }
+
+    CountingWriter& seekp(std::streamoff offset, std::ios_base::seekdir dir) {
+        if (fail()) {
+            return *this;
+        }
+
+        std::streamoff base = 0;
+        if (dir == std::ios_base::cur) {
+            base = static_cast<std::streamoff>(pos_);
+        } else if (dir == std::ios_base::end) {
+            base = static_cast<std::streamoff>(size_);
+        }
+
+        auto target = base + offset;
+        if (target < 0 || target > static_cast<std::streamoff>(size_)) {
+            state_ |= std::ios_base::failbit;
+        } else {
+            pos_ = static_cast<size_t>(target);
+        }
+
+        return *this;
+    }
+
+    CountingWriter& flush() { return *this; }
+
+    std::ios_base::iostate rdstate() const { return state_; }
+    void setstate(std::ios_base::iostate state) { state_ |= state; }
+    void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+
+    bool good() const { return state_ == std::ios_base::goodbit; }
+    bool fail() const { return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0; }
+    bool bad() const { return (state_ & std::ios_base::badbit) != 0; }
+    explicit operator bool() const { return !fail(); }
+
+    void reset() {
+        size_  = 0;
+        pos_   = 0;
+        state_ = std::ios_base::goodbit;
+    }
+
+    // Number of bytes that would have been written.
+    size_t size() const { return size_; }
+
+private:
+    size_t                 size_  = 0;
+    size_t                 pos_   = 0;
+    std::ios_base::iostate state_ = std::ios_base::goodbit;
+};
+
+}  // namespace esb
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "serialization.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace esb {
+
+// CRC-32 (IEEE 802.3) of a message name, usable at compile time to derive stable opcodes:
+//
+//     struct Login {
+//         static constexpr uint32_t opcode = esb::crc32("Login");
+//         ...
+//     };
+constexpr uint32_t crc32(std::string_view data) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (char c : data) {
+        crc ^= static_cast<uint8_t>(c);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Opcode a message type is dispatched on; its static opcode member unless specialized.
+template <typename T>
+struct opcode_of : std::integral_constant<uint32_t, T::opcode> {};
+
+namespace detail {
+
+constexpr size_t nextPowerOfTwo(size_t n) {
+    size_t power = 2;
+    while (power < n) {
+        power *= 2;
+    }
+    return power;
+}
+
+constexpr unsigned log2(size_t power) {
+    unsigned bits = 0;
+    while ((size_t{1} << bits) < power) {
+        ++bits;
+    }
+    return bits;
+}
+
+// Perfect hash over N distinct opcodes, built at compile time by hash-and-displace: opcodes are
+// grouped into buckets by one hash, and each bucket, largest first, is given the first seed that
+// places all of its opcodes into free slots of the table. A lookup is then a bucket seed load, a
+// multiplicative hash and a single comparison, whatever the number of opcodes.
+template <size_t N>
+struct opcode_table {
+    static constexpr size_t   kBuckets    = nextPowerOfTwo(N);
+    static constexpr size_t   kSlots      = kBuckets * 2;
+    static constexpr unsigned kBucketBits = log2(kBuckets);
+    static constexpr unsigned kSlotBits   = log2(kSlots);
+    static constexpr uint32_t kMaxSeed    = 1 << 16;
+
+    static constexpr size_t bucket(uint32_t opcode) {
+        return static_cast<uint32_t>(opcode * 0x85EBCA6Bu) >> (32 - kBucketBits);
+    }
+
+    static constexpr size_t slot(uint32_t opcode, uint32_t seed) {
+        return static_cast<uint32_t>((opcode ^ seed) * 0x9E3779B1u) >> (32 - kSlotBits);
+    }
+
+    // Index of the opcode in the list the table was built from, or N if it is not in it.
+    constexpr size_t find(uint32_t opcode) const {
+        auto pos = slot(opcode, seeds[bucket(opcode)]);
+        return opcodes[pos] == opcode ? indices[pos] : N;
+    }
+
+    std::array<uint32_t, kBuckets> seeds{};
+    std::array<uint32_t, kSlots>   opcodes{};
+    std::array<size_t, kSlots>     indices{};
+    bool                           distinct = true;
+    bool                           complete = true;
+};
+
+template <size_t N>
+constexpr bool placeBucket(opcode_table<N>& table, const std::array<uint32_t, N>& opcodes,
+                           size_t bucket, uint32_t seed) {
+    std::array<bool, opcode_table<N>::kSlots> taken{};
+
+    for (size_t i = 0; i < N; ++i) {
+        if (opcode_table<N>::bucket(opcodes[i]) != bucket) {
+            continue;
+        }
+
+        auto pos = opcode_table<N>::slot(opcodes[i], seed);
+        if (table.indices[pos] != N || taken[pos]) {
+            return false;
+        }
+        taken[pos] = true;
+    }
+
+    for (size_t i = 0; i < N; ++i) {
+        if (opcode_table<N>::bucket(opcodes[i]) == bucket) {
+            auto pos           = opcode_table<N>::slot(opcodes[i], seed);
+            table.opcodes[pos] = opcodes[i];
+            table.indices[pos] = i;
+        }
+    }
+
+    table.seeds[bucket] = seed;
+    return true;
+}
+
+template <size_t N>
+constexpr opcode_table<N> makeOpcodeTable(const std::array<uint32_t, N>& opcodes) {
+    using table_type = opcode_table<N>;
+
+    table_type table{};
+    for (auto& index : table.indices) {
+        index = N;
+    }
+
+    std::array<size_t, table_type::kBuckets> sizes{};
+    size_t                                   largest = 0;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = i + 1; j < N; ++j) {
+            if (opcodes[i] == opcodes[j]) {
+                table.distinct = false;
+                return table;
+            }
+        }
+
+        auto size = ++sizes[table_type::bucket(opcodes[i])];
+        largest   = size > largest ? size : largest;
+    }
+
+    for (auto size = largest; size > 0; --size) {
+        for (size_t bucket = 0; bucket < table_type::kBuckets; ++bucket) {
+            if (sizes[bucket] != size) {
+                continue;
+            }
+
+            uint32_t seed = 0;
+            while (seed < table_type::kMaxSeed && !placeBucket(table, opcodes, bucket, seed)) {
+                ++seed;
+            }
+
+            if (seed == table_type::kMaxSeed) {
+                table.complete = false;
+                return table;
+            }
+        }
+    }
+
+    return table;
+}
+
+}  // namespace detail
+
+// Routes message bodies to handlers by opcode. Opcodes are resolved through a perfect hash
+// generated at compile time from the registered message types, and each body is decoded into an
+// object owned by the dispatcher that is reused from one message to the next, so steady state
+// dispatch does not allocate. Handlers are overloaded callables taking each message type by const
+// reference.
+template <typename... Messages>
+class Dispatcher {
+public:
+    static_assert(sizeof...(Messages) > 0, "a dispatcher needs at least one message type");
+
+    // Decodes the body of the message identified by opcode from the stream and passes it to the
+    // handler. Returns false, without touching the stream, for an opcode that is not registered,
+    // and false without calling the handler when the body fails to decode.
+    template <typename StreamT, typename Handler>
+    bool dispatch(StreamT& is, uint32_t opcode, Handler&& handler) {
+        auto index = kTable.find(opcode);
+        if (index == sizeof...(Messages)) {
+            return false;
+        }
+
+        return dispatchIndex(is, index, handler, std::index_sequence_for<Messages...>{});
+    }
+
+    // Reads the opcode from the stream ahead of the body.
+    template <typename StreamT, typename Handler>
+    bool dispatch(StreamT& is, Handler&& handler) {
+        uint32_t opcode = 0;
+        read(is, opcode);
+        return !is.fail() && dispatch(is, opcode, handler);
+    }
+
+    static constexpr bool contains(uint32_t opcode) {
+        return kTable.find(opcode) != sizeof...(Messages);
+    }
+
+    // The object messages of type T are decoded into.
+    template <typename T>
+    T& message() {
+        return std::get<T>(messages_);
+    }
+
+private:
+    static constexpr auto kTable = detail::makeOpcodeTable(
+        std::array<uint32_t, sizeof...(Messages)>{opcode_of<Messages>::value...});
+
+    static_assert(kTable.distinct, "message types must have distinct opcodes");
+    static_assert(kTable.complete, "no perfect hash was found for the message opcodes");
+
+    // Expands to a comparison per message type, which compilers lower to a jump table with each
+    // decode inlined.
+    template <typename StreamT, typename Handler, size_t... Is>
+    bool dispatchIndex(StreamT& is, size_t index, Handler& handler, std::index_sequence<Is...>) {
+        bool handled = false;
+        ((index == Is && (handled = handle(is, std::get<Is>(messages_), handler), true)) || ...);
+        return handled;
+    }
+
+    template <typename StreamT, typename T, typename Handler>
+    static bool handle(StreamT& is, T& msg, Handler& handler) {
+        read(is, msg);
+
+        if (is.fail()) {
+            return false;
+        }
+
+        handler(static_cast<const T&>(msg));
+        return true;
+    }
+
+    std::tuple<Messages...> messages_;
+};
+
+}  // namespace esb
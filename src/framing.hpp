@@ -0,0 +1,157 @@
+#pragma once
+
+#include "buffer_reader.hpp"
+#include "serialization.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <iterator>
+#include <limits>
+#include <string_view>
+
+namespace esb {
+
+// Frames coalesce several messages into one buffer, such as a datagram. Each frame is a header of
+// a SizeT body size and an OpcodeT opcode, followed by the body.
+template <typename SizeT, typename OpcodeT>
+constexpr size_t frame_header_size() {
+    return sizeof(SizeT) + sizeof(OpcodeT);
+}
+
+// Writes frames to a seekable stream. The header is written with a reserved size slot ahead of the
+// body, filled in once the body is complete, so messages are encoded straight into the shared
+// buffer. Header fields use the byte order of the stream. A body too large for SizeT flags the
+// stream.
+template <typename StreamT, typename SizeT = uint16_t, typename OpcodeT = uint16_t>
+class FrameWriter {
+public:
+    using size_slot = slot<SizeT, StreamT>;
+
+    explicit FrameWriter(StreamT& os)
+        : os_{os} {}
+
+    // Starts a frame, returning the slot its size is filled into by end().
+    size_slot begin(OpcodeT opcode) {
+        auto size = esb::reserve<SizeT>(os_);
+        esb::write(os_, opcode);
+        return size;
+    }
+
+    void end(size_slot size) {
+        if (os_.fail()) {
+            return;
+        }
+
+        auto header = static_cast<std::streamoff>(frame_header_size<SizeT, OpcodeT>());
+        auto length = static_cast<size_t>(os_.tellp() - size.position() - header);
+
+        if (length > std::numeric_limits<SizeT>::max()) {
+            os_.setstate(std::ios_base::failbit);
+            return;
+        }
+
+        size.set(static_cast<SizeT>(length));
+        ++count_;
+    }
+
+    template <typename T>
+    void write(OpcodeT opcode, const T& message) {
+        auto start = begin(opcode);
+        esb::write(os_, message);
+        end(start);
+    }
+
+    // Number of frames completed so far.
+    size_t count() const { return count_; }
+
+private:
+    StreamT& os_;
+    size_t   count_ = 0;
+};
+
+template <typename OpcodeT>
+struct Frame {
+    OpcodeT      opcode;
+    BufferReader body;
+};
+
+// Walks the frames in a received buffer, handing out each body as a BufferReader over the buffer
+// itself. Iteration stops at the end of the buffer or at the first truncated frame, in which case
+// fail() reports it. Header fields are read in the given byte order.
+template <typename SizeT = uint16_t, typename OpcodeT = uint16_t, typename Order = native>
+class FrameReader {
+public:
+    using frame_type = Frame<OpcodeT>;
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = frame_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const frame_type*;
+        using reference         = const frame_type&;
+
+        iterator() = default;
+
+        explicit iterator(FrameReader* frames)
+            : frames_{frames} {
+            ++*this;
+        }
+
+        reference operator*() const { return frame_; }
+        pointer   operator->() const { return &frame_; }
+
+        iterator& operator++() {
+            if (!frames_->next(frame_)) {
+                frames_ = nullptr;
+            }
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const { return frames_ == other.frames_; }
+        bool operator!=(const iterator& other) const { return frames_ != other.frames_; }
+
+    private:
+        FrameReader* frames_ = nullptr;
+        frame_type   frame_{};
+    };
+
+    FrameReader(const char* data, size_t size)
+        : reader_{data, size} {}
+
+    explicit FrameReader(std::string_view data)
+        : reader_{data} {}
+
+    // Advances to the next frame, returning false at the end of the buffer or on a truncated frame.
+    bool next(frame_type& frame) {
+        if (reader_.fail() || reader_.remaining() == 0) {
+            return false;
+        }
+
+        SizeT   size   = 0;
+        OpcodeT opcode = {};
+        esb::read(reader_, size, Order{});
+        esb::read(reader_, opcode, Order{});
+
+        auto body = reader_.consume(size);
+        if (reader_.fail() || body == nullptr) {
+            reader_.setstate(std::ios_base::failbit);
+            return false;
+        }
+
+        frame.opcode = opcode;
+        frame.body   = BufferReader{body, size};
+        return true;
+    }
+
+    iterator begin() { return iterator{this}; }
+    iterator end() { return iterator{}; }
+
+    bool fail() const { return reader_.fail(); }
+
+private:
+    BufferReader reader_;
+};
+
+}  // namespace esb
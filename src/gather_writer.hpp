@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <ios>
+#include <string_view>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
+
+namespace esb {
+
+// Write-only stream for vectored I/O. Small writes are copied into an internal buffer, while the
+// contents of strings and arrays of at least threshold bytes are referenced where they are, so
+// large payloads reach writev or sendmsg without being copied. The output is exposed as a list of
+// segments in write order, and as an iovec array on POSIX systems. Referenced bytes must stay
+// alive and unchanged until the output has been sent.
+class GatherWriter {
+public:
+    static constexpr size_t kDefaultThreshold = 512;
+
+    GatherWriter() = default;
+
+    explicit GatherWriter(size_t threshold)
+        : threshold_{threshold} {}
+
+    GatherWriter& write(const char* src, std::streamsize count) {
+        // A failed writer ignores further output, so an abandoned message leaves no partial frame.
+        auto length = static_cast<size_t>(count);
+        if (fail() || length == 0) {
+            return *this;
+        }
+
+        if (segments_.empty() || segments_.back().external != nullptr) {
+            segments_.push_back({nullptr, buffer_.size(), 0});
+        }
+
+        buffer_.insert(buffer_.end(), src, src + length);
+
+        segments_.back().size += length;
+        size_ += length;
+        return *this;
+    }
+
+    GatherWriter& writeReference(const char* src, size_t count) {
+        if (fail()) {
+            return *this;
+        }
+
+        if (count < threshold_) {
+            return write(src, static_cast<std::streamsize>(count));
+        }
+
+        segments_.push_back({src, 0, count});
+        size_ += count;
+        return *this;
+    }
+
+    std::streampos tellp() const {
+        return fail() ? std::streampos(-1) : std::streampos(static_cast<std::streamoff>(size_));
+    }
+
+    GatherWriter& flush() { return *this; }
+
+    std::ios_base::iostate rdstate() const { return state_; }
+    void setstate(std::ios_base::iostate state) { state_ |= state; }
+    void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+
+    bool good() const { return state_ == std::ios_base::goodbit; }
+    bool fail() const { return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0; }
+    bool bad() const { return (state_ & std::ios_base::badbit) != 0; }
+    explicit operator bool() const { return !fail(); }
+
+    // Empties the writer, keeping its storage for the next message.
+    void reset() {
+        buffer_.clear();
+        segments_.clear();
+        size_  = 0;
+        state_ = std::ios_base::goodbit;
+    }
+
+    // Total number of bytes written, copied or referenced.
+    size_t size() const { return size_; }
+
+    size_t segmentCount() const { return segments_.size(); }
+
+    // Views into the internal buffer are invalidated by the next write.
+    std::string_view segment(size_t index) const {
+        const auto& seg = segments_[index];
+        return {seg.external != nullptr ? seg.external : buffer_.data() + seg.offset, seg.size};
+    }
+
+#if !defined(_WIN32)
+    // Fills an iovec array describing the output, reusing its storage across messages. The array
+    // is invalidated by the next write.
+    const std::vector<iovec>& iovecs() {
+        iovecs_.resize(segments_.size());
+
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            auto bytes          = segment(i);
+            iovecs_[i].iov_base = const_cast<char*>(bytes.data());
+            iovecs_[i].iov_len  = bytes.size();
+        }
+
+        return iovecs_;
+    }
+#endif
+
+private:
+    // A run of bytes either referenced in place or, when external is null, stored in buffer_.
+    struct Segment {
+        const char* external;
+        size_t      offset;
+        size_t      size;
+    };
+
+    std::vector<char>    buffer_;
+    std::vector<Segment> segments_;
+#if !defined(_WIN32)
+    std::vector<iovec> iovecs_;
+#endif
+    size_t                 threshold_ = kDefaultThreshold;
+    size_t                 size_      = 0;
+    std::ios_base::iostate state_     = std::ios_base::goodbit;
+};
+
+}  // namespace esb
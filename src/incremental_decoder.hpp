@@ -0,0 +1,352 @@
+#pragma once
+
+#include "buffer_reader.hpp"
+#include "serialization.hpp"
+#include "varint.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace esb {
+
+// Decodes a T from input that arrives in pieces, such as successive reads from a socket, without
+// first collecting the whole message. Each feed() consumes as much of a chunk as the message needs
+// and, when the chunk runs out, records how far decoding got as one progress frame per level of
+// nesting; the next feed() walks back down those frames and resumes where it stopped. Strings and
+// vectors are filled in place as their bytes arrive, so the only input ever held back is a single
+// fixed size value or varint split across chunks.
+//
+// The stream type supplies the byte order, length prefix and length limit policies, and is
+// constructed over spans of the input to decode the individual values, as BufferReader is:
+//
+//     esb::IncrementalDecoder<Snapshot, ClientReader> decoder;
+//     while (!decoder.done() && !decoder.fail()) {
+//         auto received = socket.receive(buffer, sizeof(buffer));
+//         decoder.feed(buffer, received);
+//     }
+template <typename T, typename StreamT = BufferReader>
+class IncrementalDecoder {
+public:
+    // Deepest nesting of strings, vectors, arrays and structs within T that can be decoded.
+    static constexpr size_t kMaxDepth = 16;
+
+    IncrementalDecoder() = default;
+
+    // Decodes into an existing value, for example one constructed with a particular allocator.
+    explicit IncrementalDecoder(T value)
+        : value_{std::move(value)} {}
+
+    // Feeds the next chunk of input and returns how many of its bytes were consumed. All of them
+    // are, unless the message completes within the chunk; the rest then belong to what follows.
+    size_t feed(const char* data, size_t size) {
+        if (done_ || failed_) {
+            return 0;
+        }
+
+        input_     = data;
+        available_ = size;
+        done_      = decode(value_, 0);
+
+        return size - available_;
+    }
+
+    size_t feed(std::string_view data) { return feed(data.data(), data.size()); }
+
+    // Prepares for the next message, decoding it into the same value so that its strings and
+    // vectors keep their capacity.
+    void reset() {
+        frames_ = {};
+        staged_ = 0;
+        done_   = false;
+        failed_ = false;
+    }
+
+    bool done() const { return done_; }
+    bool fail() const { return failed_; }
+
+    T&       value() { return value_; }
+    const T& value() const { return value_; }
+
+private:
+    // Progress within a string, vector, array or struct: index counts the elements or fields
+    // completed, offset by one for strings and vectors once their length has been read.
+    struct Frame {
+        size_t index  = 0;
+        size_t length = 0;
+    };
+
+    Frame* frameAt(size_t depth) {
+        if (depth >= kMaxDepth) {
+            failed_ = true;
+            return nullptr;
+        }
+
+        return &frames_[depth];
+    }
+
+    void advance(size_t count) {
+        input_ += count;
+        available_ -= count;
+    }
+
+    bool check(const StreamT& reader) {
+        failed_ = failed_ || reader.fail();
+        return !failed_;
+    }
+
+    // Reads a fixed size value straight from the input when it is all there, and otherwise
+    // stages what has arrived until the rest does.
+    template <typename U>
+    bool decodeFixed(U& val) {
+        constexpr size_t size = fixed_serialized_size<U>::value;
+
+        if (staged_ == 0 && available_ >= size) {
+            StreamT reader{input_, size};
+            read(reader, val);
+            advance(size);
+            return check(reader);
+        }
+
+        if (staging_.size() < size) {
+            staging_.resize(size);
+        }
+
+        auto chunk = available_ < size - staged_ ? available_ : size - staged_;
+        std::memcpy(staging_.data() + staged_, input_, chunk);
+        advance(chunk);
+        staged_ += chunk;
+
+        if (staged_ < size) {
+            return false;
+        }
+
+        staged_ = 0;
+        StreamT reader{staging_.data(), size};
+        read(reader, val);
+        return check(reader);
+    }
+
+    // Stages the bytes of a varint up to the one without a continuation bit; an encoding longer
+    // than maxSize is left for read to reject.
+    template <typename U>
+    bool decodeVarint(U& val, size_t maxSize) {
+        if (staging_.size() < maxSize) {
+            staging_.resize(maxSize);
+        }
+
+        bool complete = false;
+        while (!complete && available_ > 0 && staged_ < maxSize) {
+            complete             = (*input_ & 0x80) == 0;
+            staging_[staged_++] = *input_;
+            advance(1);
+        }
+
+        if (!complete && staged_ < maxSize) {
+            return false;
+        }
+
+        StreamT reader{staging_.data(), staged_};
+        staged_ = 0;
+        read(reader, val);
+        return check(reader);
+    }
+
+    template <typename Prefix>
+    bool decodeLength(size_t& length, Prefix) {
+        if constexpr (std::is_same<Prefix, prefix::varint>::value) {
+            esb::varint<uint32_t> tmp;
+            if (!decodeVarint(tmp, max_varint_size<uint32_t>())) {
+                return false;
+            }
+            length = tmp.value;
+        } else {
+            typename Prefix::type tmp = 0;
+            if (!decodeFixed(tmp)) {
+                return false;
+            }
+            length = tmp;
+        }
+
+        if (length > length_limit_of<StreamT>::value) {
+            failed_ = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    template <typename U>
+    bool decode(varint<U>& val, size_t) {
+        return decodeVarint(val, max_varint_size<U>());
+    }
+
+    template <typename U>
+    bool decode(zigzag<U>& val, size_t) {
+        return decodeVarint(val, max_varint_size<U>());
+    }
+
+    template <typename Traits, typename Alloc>
+    bool decode(std::basic_string<char, Traits, Alloc>& val, size_t depth) {
+        auto frame = frameAt(depth);
+        if (frame == nullptr) {
+            return false;
+        }
+
+        if (frame->index == 0) {
+            if (!decodeLength(frame->length, length_prefix_t<StreamT>{})) {
+                return false;
+            }
+
+            frame->index = 1;
+            val.clear();
+        }
+
+        auto missing = frame->length - val.size();
+        auto chunk   = available_ < missing ? available_ : missing;
+        val.append(input_, chunk);
+        advance(chunk);
+
+        if (val.size() < frame->length) {
+            return false;
+        }
+
+        *frame = {};
+        return true;
+    }
+
+    // Elements are appended as they start arriving, rather than all at once from the count, so
+    // memory grows only with the input actually received. Runs of whole fixed size elements in
+    // a chunk are read with a single sequence read.
+    template <typename U, typename Alloc>
+    bool decode(std::vector<U, Alloc>& val, size_t depth) {
+        static_assert(!std::is_same<U, bool>::value, "std::vector<bool> is not supported");
+
+        auto frame = frameAt(depth);
+        if (frame == nullptr) {
+            return false;
+        }
+
+        if (frame->index == 0) {
+            if (!decodeLength(frame->length, prefix::u32{})) {
+                return false;
+            }
+
+            frame->index = 1;
+            if (frame->length < val.size()) {
+                val.resize(frame->length);
+            }
+        }
+
+        while (frame->index - 1 < frame->length) {
+            auto i = frame->index - 1;
+
+            if constexpr (is_fixed_size<U>::value) {
+                constexpr size_t size = fixed_serialized_size<U>::value;
+
+                auto whole = available_ / size;
+                whole      = whole < frame->length - i ? whole : frame->length - i;
+
+                if (staged_ == 0 && whole > 1) {
+                    if (val.size() < i + whole) {
+                        val.resize(i + whole);
+                    }
+
+                    StreamT reader{input_, whole * size};
+                    detail::readSequence(reader, val.data() + i, whole, byte_order_t<StreamT>{});
+                    advance(whole * size);
+
+                    if (!check(reader)) {
+                        return false;
+                    }
+
+                    frame->index += whole;
+                    continue;
+                }
+            }
+
+            if (val.size() <= i) {
+                val.resize(i + 1);
+            }
+
+            if (!decode(val[i], depth + 1)) {
+                return false;
+            }
+
+            ++frame->index;
+        }
+
+        *frame = {};
+        return true;
+    }
+
+    template <typename U, size_t N>
+    bool decode(std::array<U, N>& val, size_t depth) {
+        if constexpr (is_fixed_size<std::array<U, N>>::value) {
+            return decodeFixed(val);
+        } else {
+            auto frame = frameAt(depth);
+            if (frame == nullptr) {
+                return false;
+            }
+
+            while (frame->index < N) {
+                if (!decode(val[frame->index], depth + 1)) {
+                    return false;
+                }
+
+                ++frame->index;
+            }
+
+            *frame = {};
+            return true;
+        }
+    }
+
+    // Fixed size values, and structs declaring their fields, whose fields are resumed from the
+    // first one not yet completed.
+    template <typename U>
+    bool decode(U& val, size_t depth) {
+        if constexpr (is_fixed_size<U>::value) {
+            return decodeFixed(val);
+        } else {
+            static_assert(has_fields<U>::value, "type cannot be decoded incrementally");
+
+            auto frame = frameAt(depth);
+            if (frame == nullptr) {
+                return false;
+            }
+
+            size_t field    = 0;
+            bool   complete = val.esbVisitFields([&](auto&... fields) {
+                return ((field++ < frame->index ||
+                         (decode(fields, depth + 1) && (++frame->index, true))) &&
+                        ...);
+            });
+
+            if (!complete) {
+                return false;
+            }
+
+            *frame = {};
+            return true;
+        }
+    }
+
+    T                            value_{};
+    std::array<Frame, kMaxDepth> frames_{};
+    std::vector<char>            staging_;
+    size_t                       staged_    = 0;
+    const char*                  input_     = nullptr;
+    size_t                       available_ = 0;
+    bool                         done_      = false;
+    bool                         failed_    = false;
+};
+
+}  // namespace esb
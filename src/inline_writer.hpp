@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <string_view>
+
+namespace esb {
+
+// Write-only stream whose storage is embedded in the object itself, so building a packet never
+// touches the heap. A write that would exceed the fixed capacity of N bytes writes nothing and
+// sets failbit and badbit; all further writes are ignored until the writer is reset.
+template <size_t N>
+class InlineWriter {
+public:
+    InlineWriter& write(const char* src, std::streamsize count) {
+        auto length = static_cast<size_t>(count);
+
+        if (fail() || length > N - pos_) {
+            state_ |= std::ios_base::failbit | std::ios_base::badbit;
+            return *this;
+        }
+
+        // Empty writes, e.g. of an empty vector, may pass a null source.
+        if (length > 0) {
+            std::memcpy(buffer_ + pos_, src, length);
+        }
+        pos_ += length;
+
+        if (pos_ > size_) {
+            size_ = pos_;
+        }
+
+        return *this;
+    }
+
+    std::streampos tellp() const {
+        return fail() ? std::streampos(-1) : std::streampos(static_cast<std::streamoff>(pos_));
+    }
+
+    InlineWriter& seekp(std::streampos pos) {
+        return seekp(static_cast<std::streamoff>(pos), std::ios_base::beg);
+    }
+
+    InlineWriter& seekp(std::streamoff offset, std::ios_base::seekdir dir) {
+        if (fail()) {
+            return *this;
+        }
+
+        std::streamoff base = 0;
+        if (dir == std::ios_base::cur) {
+            base = static_cast<std::streamoff>(pos_);
+        } else if (dir == std::ios_base::end) {
+            base = static_cast<std::streamoff>(size_);
+        }
+
+        auto target = base + offset;
+        if (target < 0 || target > static_cast<std::streamoff>(size_)) {
+            state_ |= std::ios_base::failbit;
+        } else {
+            pos_ = static_cast<size_t>(target);
+        }
+
+        return *this;
+    }
+
+    InlineWriter& flush() { return *this; }
+
+    std::ios_base::iostate rdstate() const { return state_; }
+    void setstate(std::ios_base::iostate state) { state_ |= state; }
+    void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+
+    bool good() const { return state_ == std::ios_base::goodbit; }
+    bool fail() const { return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0; }
+    bool bad() const { return (state_ & std::ios_base::badbit) != 0; }
+    explicit operator bool() const { return !fail(); }
+
+    void reset() {
+        size_  = 0;
+        pos_   = 0;
+        state_ = std::ios_base::goodbit;
+    }
+
+    char*            data() { return buffer_; }
+    const char*      data() const { return buffer_; }
+    size_t           size() const { return size_; }
+    std::string_view view() const { return {buffer_, size_}; }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    char                   buffer_[N];
+    size_t                 size_  = 0;
+    size_t                 pos_   = 0;
+    std::ios_base::iostate state_ = std::ios_base::goodbit;
+};
+
+}  // namespace esb
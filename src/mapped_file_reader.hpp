@@ -0,0 +1,175 @@
+#pragma once
+
+#include "buffer_reader.hpp"
+
+#include <cstddef>
+#include <ios>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace esb {
+
+// Access pattern hints for a mapped file, forwarded to madvise on POSIX systems and ignored
+// elsewhere.
+enum class access_hint { normal, sequential, random, willneed };
+
+// Read-only stream over a memory mapped file. The file is read directly from the page cache, with
+// no intermediate buffering, and string_view reads return views into the mapping that stay valid
+// for the lifetime of the reader. A file that cannot be opened or mapped leaves the reader empty
+// with failbit set. Readers own their mapping and can only be moved; view() hands out copyable
+// BufferReaders over the same bytes, for instance to read at several positions concurrently.
+class MappedFileReader : public BufferReader {
+public:
+    MappedFileReader() = default;
+
+    explicit MappedFileReader(const char* path)
+        : MappedFileReader(map(path)) {}
+
+    MappedFileReader(const MappedFileReader&) = delete;
+    MappedFileReader& operator=(const MappedFileReader&) = delete;
+
+    MappedFileReader(MappedFileReader&& other) noexcept
+        : BufferReader{other}
+        , mapping_{std::exchange(other.mapping_, Mapping{})} {
+        static_cast<BufferReader&>(other) = BufferReader{};
+    }
+
+    MappedFileReader& operator=(MappedFileReader&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            static_cast<BufferReader&>(*this) = other;
+            mapping_                          = std::exchange(other.mapping_, Mapping{});
+            static_cast<BufferReader&>(other) = BufferReader{};
+        }
+        return *this;
+    }
+
+    ~MappedFileReader() { unmap(); }
+
+    bool isOpen() const { return mapping_.opened; }
+
+    void advise(access_hint hint) const {
+#if !defined(_WIN32)
+        if (mapping_.data == nullptr) {
+            return;
+        }
+
+        int advice = MADV_NORMAL;
+        if (hint == access_hint::sequential) {
+            advice = MADV_SEQUENTIAL;
+        } else if (hint == access_hint::random) {
+            advice = MADV_RANDOM;
+        } else if (hint == access_hint::willneed) {
+            advice = MADV_WILLNEED;
+        }
+
+        ::madvise(const_cast<char*>(mapping_.data), mapping_.size, advice);
+#else
+        (void)hint;
+#endif
+    }
+
+    BufferReader view() const { return BufferReader{data(), size()}; }
+
+private:
+    struct Mapping {
+        const char* data   = nullptr;
+        size_t      size   = 0;
+        bool        opened = false;
+    };
+
+    explicit MappedFileReader(Mapping mapping)
+        : BufferReader{mapping.data, mapping.size}
+        , mapping_{mapping} {
+        if (!mapping.opened) {
+            setstate(std::ios_base::failbit);
+        }
+    }
+
+    // Empty files are opened but not mapped, since zero length mappings are not allowed.
+    static Mapping map(const char* path) {
+        Mapping mapping;
+
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return mapping;
+        }
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(file, &size)) {
+            size.QuadPart = -1;
+        }
+
+        if (size.QuadPart == 0) {
+            mapping.opened = true;
+        } else if (size.QuadPart > 0) {
+            HANDLE view = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (view != nullptr) {
+                auto data = ::MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+                if (data != nullptr) {
+                    mapping.data   = static_cast<const char*>(data);
+                    mapping.size   = static_cast<size_t>(size.QuadPart);
+                    mapping.opened = true;
+                }
+                ::CloseHandle(view);
+            }
+        }
+
+        ::CloseHandle(file);
+#else
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return mapping;
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            info.st_size = -1;
+        }
+
+        if (info.st_size == 0) {
+            mapping.opened = true;
+        } else if (info.st_size > 0) {
+            void* data = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE,
+                                fd, 0);
+            if (data != MAP_FAILED) {
+                mapping.data   = static_cast<const char*>(data);
+                mapping.size   = static_cast<size_t>(info.st_size);
+                mapping.opened = true;
+            }
+        }
+
+        ::close(fd);
+#endif
+
+        return mapping;
+    }
+
+    void unmap() {
+        if (mapping_.data != nullptr) {
+#if defined(_WIN32)
+            ::UnmapViewOfFile(mapping_.data);
+#else
+            ::munmap(const_cast<char*>(mapping_.data), mapping_.size);
+#endif
+        }
+        mapping_ = Mapping{};
+    }
+
+    Mapping mapping_;
+};
+
+}  // namespace esb
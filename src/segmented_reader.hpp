@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <string_view>
+#include <utility>
+
+namespace esb {
+
+// Read-only stream over a chain of non-contiguous segments, such as the fixed size receive buffers
+// a message arrived in, so that it can be decoded without first being stitched together. Reads
+// that fall within one segment are a single bounded memcpy; only reads straddling a boundary take
+// the slower path that copies piecewise across segments. Neither the segment list nor the bytes
+// it refers to are owned by the reader, and both must outlive it, so copies are independent
+// cursors and readAt/peekAt read through one, even on a const reader.
+class SegmentedReader {
+public:
+    using positional_view = void;
+
+    SegmentedReader() = default;
+
+    SegmentedReader(const std::string_view* segments, size_t count)
+        : segments_{segments}
+        , count_{count} {
+        for (size_t i = 0; i < count; ++i) {
+            size_ += segments[i].size();
+        }
+    }
+
+    // Accepts any contiguous container of string_views, such as std::vector or std::array.
+    template <typename SegmentsT,
+              typename = decltype(std::declval<const SegmentsT&>().data() +
+                                  std::declval<const SegmentsT&>().size())>
+    explicit SegmentedReader(const SegmentsT& segments)
+        : SegmentedReader(segments.data(), segments.size()) {}
+
+    SegmentedReader& read(char* dst, std::streamsize count) {
+        auto length = static_cast<size_t>(count);
+
+        if (index_ < count_ && length <= segments_[index_].size() - pos_) {
+            if (length > 0) {
+                std::memcpy(dst, segments_[index_].data() + pos_, length);
+            }
+            pos_ += length;
+            gcount_ = count;
+            return *this;
+        }
+
+        return readAcross(dst, length);
+    }
+
+    std::streampos tellg() const {
+        return fail() ? std::streampos(-1)
+                      : std::streampos(static_cast<std::streamoff>(position()));
+    }
+
+    SegmentedReader& seekg(std::streampos pos) {
+        return seekg(static_cast<std::streamoff>(pos), std::ios_base::beg);
+    }
+
+    SegmentedReader& seekg(std::streamoff offset, std::ios_base::seekdir dir) {
+        state_ &= ~std::ios_base::eofbit;
+
+        if (fail()) {
+            return *this;
+        }
+
+        std::streamoff base = 0;
+        if (dir == std::ios_base::cur) {
+            base = static_cast<std::streamoff>(position());
+        } else if (dir == std::ios_base::end) {
+            base = static_cast<std::streamoff>(size_);
+        }
+
+        auto target = base + offset;
+        if (target < 0 || target > static_cast<std::streamoff>(size_)) {
+            state_ |= std::ios_base::failbit;
+            return *this;
+        }
+
+        // Walk from the current segment, landing at the end of the segment holding the target so
+        // that a position at a boundary stays reachable from either side.
+        auto absolute = static_cast<size_t>(target);
+        while (index_ > 0 && absolute <= offset_) {
+            --index_;
+            offset_ -= segments_[index_].size();
+        }
+        while (index_ + 1 < count_ && absolute > offset_ + segments_[index_].size()) {
+            offset_ += segments_[index_].size();
+            ++index_;
+        }
+        pos_ = absolute - offset_;
+
+        return *this;
+    }
+
+    std::streamsize gcount() const { return gcount_; }
+
+    std::ios_base::iostate rdstate() const { return state_; }
+    void setstate(std::ios_base::iostate state) { state_ |= state; }
+    void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+
+    bool good() const { return state_ == std::ios_base::goodbit; }
+    bool eof() const { return (state_ & std::ios_base::eofbit) != 0; }
+    bool fail() const { return (state_ & (std::ios_base::failbit | std::ios_base::badbit)) != 0; }
+    explicit operator bool() const { return !fail(); }
+
+    size_t segmentCount() const { return count_; }
+    size_t size() const { return size_; }
+    size_t position() const { return offset_ + pos_; }
+    size_t remaining() const { return size_ - position(); }
+
+private:
+    SegmentedReader& readAcross(char* dst, size_t length) {
+        size_t copied = 0;
+
+        while (copied < length && index_ < count_) {
+            auto available = segments_[index_].size() - pos_;
+
+            if (available == 0) {
+                if (index_ + 1 == count_) {
+                    break;
+                }
+
+                offset_ += segments_[index_].size();
+                ++index_;
+                pos_ = 0;
+                continue;
+            }
+
+            auto chunk = length - copied < available ? length - copied : available;
+            std::memcpy(dst + copied, segments_[index_].data() + pos_, chunk);
+            pos_ += chunk;
+            copied += chunk;
+        }
+
+        gcount_ = static_cast<std::streamsize>(copied);
+        if (copied < length) {
+            state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+        }
+
+        return *this;
+    }
+
+    const std::string_view* segments_ = nullptr;
+    size_t                  count_    = 0;
+    size_t                  size_     = 0;
+    size_t                  index_    = 0;
+    size_t                  offset_   = 0;
+    size_t                  pos_      = 0;
+    std::streamsize         gcount_   = 0;
+    std::ios_base::iostate  state_    = std::ios_base::goodbit;
+};
+
+}  // namespace esb
@@ -1,70 +1,1085 @@
 
 #pragma once
 
+#include "byte_order.hpp"
+#include "varint.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ios>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+// Declares the members of a struct that make up its serialized form, in wire order, allowing
+// esb::read and esb::write to be used on the struct directly:
+//
+//     struct PositionUpdate {
+//         uint64_t id;
+//         float    x, y, z;
+//
+//         ESB_FIELDS(id, x, y, z)
+//     };
+//
+// Each field is read or written with the overload for its type, in a fold expression expanded at
+// compile time, so the output is identical to hand written calls for each field.
+#define ESB_FIELDS(...)                                      \
+    template <typename EsbFn>                                \
+    decltype(auto) esbVisitFields(EsbFn&& esbFn) {           \
+        return esbFn(__VA_ARGS__);                           \
+    }                                                        \
+    template <typename EsbFn>                                \
+    decltype(auto) esbVisitFields(EsbFn&& esbFn) const {     \
+        return esbFn(__VA_ARGS__);                           \
+    }
 
 namespace esb {
 
+// Element types whose in-memory representation is their serialized form, allowing contiguous
+// sequences of them to be transferred with a single stream call.
+template <typename T>
+struct is_bulk_serializable
+    : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value> {};
+
+// Streams over memory that can lend out their bytes in place through consume(count), which returns
+// a pointer to the next count bytes and advances past them, or nullptr on a short read.
+template <typename StreamT, typename = void>
+struct is_contiguous_stream : std::false_type {};
+
+template <typename StreamT>
+struct is_contiguous_stream<
+    StreamT, std::void_t<decltype(std::declval<StreamT&>().consume(std::declval<size_t>()))>>
+    : std::true_type {};
+
+// String length prefix policies. As with byte orders, a policy can be passed as the trailing
+// argument of a string read/write or declared for a whole stream as a nested length_prefix type.
+// Streams that declare neither use a uint16_t prefix.
+namespace prefix {
+
+struct u8 {
+    using type = uint8_t;
+};
+
+struct u16 {
+    using type = uint16_t;
+};
+
+struct u32 {
+    using type = uint32_t;
+};
+
+struct varint {
+    using type = uint32_t;
+};
+
+}  // namespace prefix
+
+template <typename T>
+struct is_length_prefix
+    : std::integral_constant<bool, std::is_same<T, prefix::u8>::value ||
+                                       std::is_same<T, prefix::u16>::value ||
+                                       std::is_same<T, prefix::u32>::value ||
+                                       std::is_same<T, prefix::varint>::value> {};
+
+template <typename StreamT, typename = void>
+struct length_prefix_of {
+    using type = prefix::u16;
+};
+
+template <typename StreamT>
+struct length_prefix_of<StreamT, std::void_t<typename StreamT::length_prefix>> {
+    using type = typename StreamT::length_prefix;
+};
+
+template <typename StreamT>
+using length_prefix_t = typename length_prefix_of<StreamT>::type;
+
+// Streams that are cheap, non-owning views over memory, whose copies are independent cursors over
+// the same bytes, opt in to being copied to read at an arbitrary position without disturbing the
+// original by declaring a nested positional_view type:
+//
+//     using positional_view = void;
+//
+// Streams deriving from one that owns its memory are excluded by being move-only.
+template <typename StreamT, typename = void>
+struct is_positional_stream : std::false_type {};
+
+template <typename StreamT>
+struct is_positional_stream<StreamT, std::void_t<typename StreamT::positional_view>>
+    : std::is_copy_constructible<StreamT> {};
+
+// Streams that can report how many unread bytes they hold through remaining(), allowing length
+// prefixes to be checked against the input before anything is allocated for them.
+template <typename StreamT, typename = void>
+struct has_remaining : std::false_type {};
+
+template <typename StreamT>
+struct has_remaining<StreamT, std::void_t<decltype(std::declval<const StreamT&>().remaining())>>
+    : std::true_type {};
+
+// Streams that can record a reference to caller owned bytes instead of copying them, through
+// writeReference(data, count). Only bytes that belong to the value being written, such as the
+// contents of strings and arrays, are passed this way; staging buffers are always written.
+template <typename StreamT, typename = void>
+struct is_gather_stream : std::false_type {};
+
+template <typename StreamT>
+struct is_gather_stream<StreamT, std::void_t<decltype(std::declval<StreamT&>().writeReference(
+                                     std::declval<const char*>(), std::declval<size_t>()))>>
+    : std::true_type {};
+
+// Writers over memory that expose their bytes for modification through data(), allowing a value
+// reserved earlier to be filled in with a direct store instead of a seek and write.
+template <typename StreamT, typename = void>
+struct is_patchable_stream : std::false_type {};
+
+template <typename StreamT>
+struct is_patchable_stream<StreamT,
+                           std::enable_if_t<std::is_same<decltype(std::declval<StreamT&>().data()),
+                                                         char*>::value>> : std::true_type {};
+
+namespace detail {
+
+template <typename StreamT>
+void writeBytes(StreamT& os, const char* data, size_t count) {
+    if constexpr (is_gather_stream<StreamT>::value) {
+        os.writeReference(data, count);
+    } else {
+        os.write(data, static_cast<std::streamsize>(count));
+    }
+}
+
+// Upper bound on the bytes left in a stream; unbounded for streams that cannot tell.
+template <typename StreamT>
+size_t remainingBytes(const StreamT& is) {
+    if constexpr (has_remaining<StreamT>::value) {
+        return is.remaining();
+    } else {
+        return std::numeric_limits<size_t>::max();
+    }
+}
+
+// Most bytes of string or vector storage allocated ahead of the input on streams without
+// remaining(), whose length prefixes cannot be checked against what is left.
+constexpr size_t kUnboundedReadChunk = 4096;
+
+// Resizes val to count elements and passes them to readElements(offset, n), which reads them and
+// returns whether to go on. Streams exposing remaining() have already bounded count by the input,
+// so all elements are created at once; on other streams longer contents are created a chunk at a
+// time as the previous chunk arrives, so a count the input cannot back fails after allocating at
+// most one chunk more than was read.
+template <typename StreamT, typename ContainerT, typename ReadFn>
+void readResized(const StreamT&, ContainerT& val, size_t count, ReadFn&& readElements) {
+    constexpr size_t elementSize = sizeof(typename ContainerT::value_type);
+    constexpr size_t chunk =
+        elementSize < kUnboundedReadChunk ? kUnboundedReadChunk / elementSize : 1;
+
+    if (has_remaining<StreamT>::value || count <= chunk) {
+        val.resize(count);
+        readElements(size_t{0}, count);
+        return;
+    }
+
+    for (size_t offset = 0; offset < count; offset += chunk) {
+        auto n = count - offset < chunk ? count - offset : chunk;
+        val.resize(offset + n);
+
+        if (!readElements(offset, n)) {
+            return;
+        }
+    }
+}
+
+}  // namespace detail
+
+// Caps on the length of strings and the element count of containers accepted by a read. A cap can
+// be passed as the trailing argument of a string or vector read, or declared for every read from a
+// stream as a static length_limit member:
+//
+//     struct ClientReader : esb::BufferReader {
+//         static constexpr size_t length_limit = 4096;
+//         using BufferReader::BufferReader;
+//     };
+//
+// Regardless of caps, streams exposing remaining() reject lengths the input cannot hold. Either
+// way the length is checked before anything is allocated; a rejected length flags the stream and
+// leaves the value untouched. On streams without remaining(), such as std::istream, strings and
+// vectors beyond a few KiB grow in chunks as their bytes arrive rather than all at once.
+struct length_limit {
+    size_t value;
+};
+
+template <typename StreamT, typename = void>
+struct length_limit_of : std::integral_constant<size_t, std::numeric_limits<size_t>::max()> {};
+
+template <typename StreamT>
+struct length_limit_of<StreamT, std::void_t<decltype(StreamT::length_limit)>>
+    : std::integral_constant<size_t, StreamT::length_limit> {};
+
+namespace detail {
+
+// Accepts a length read from the input if it is within limit and that many elements, of at least
+// elementSize bytes each, fit in what is left of the input; otherwise flags the stream.
+template <typename StreamT>
+bool checkLength(StreamT& is, size_t length, size_t elementSize, size_t limit) {
+    if (is.fail() || length > limit ||
+        (elementSize != 0 && length > remainingBytes(is) / elementSize)) {
+        is.setstate(std::ios_base::failbit);
+        return false;
+    }
+
+    return true;
+}
+
+struct field_probe {
+    template <typename... Fields>
+    void operator()(Fields&...) const {}
+};
+
+}  // namespace detail
+
+// Types that declare their serialized fields with ESB_FIELDS.
+template <typename T, typename = void>
+struct has_fields : std::false_type {};
+
+template <typename T>
+struct has_fields<T, std::void_t<decltype(std::declval<T&>().esbVisitFields(
+                        std::declval<detail::field_probe>()))>> : std::true_type {};
+
+// Opt-in for structs whose in-memory bytes are already their serialized form, so that they, and
+// arrays of them, are transferred with a single stream call instead of field by field whenever
+// the stream uses the native byte order:
+//
+//     #pragma pack(push, 1)
+//     struct PositionUpdate { ... };
+//     #pragma pack(pop)
+//
+//     template <>
+//     struct esb::is_wire_compatible<PositionUpdate> : std::true_type {};
+//
+// The claim is checked at compile time: the type must be trivially copyable and either have unique
+// object representations or declare ESB_FIELDS, in declaration order, covering every byte of the
+// struct with arithmetic, enum or wire compatible fields.
+template <typename T>
+struct is_wire_compatible : std::false_type {};
+
+namespace detail {
+
+template <typename... Ts>
+struct type_list {};
+
+struct field_types_probe {
+    template <typename... Fields>
+    constexpr type_list<std::remove_cv_t<Fields>...> operator()(Fields&...) const {
+        return {};
+    }
+};
+
+// The types of the fields declared with ESB_FIELDS, as a type_list.
+template <typename T>
+using field_types_t = decltype(std::declval<T&>().esbVisitFields(field_types_probe{}));
+
+template <typename FieldList>
+struct packed_field_list;
+
+template <typename... Fields>
+struct packed_field_list<type_list<Fields...>> {
+    static constexpr bool layout =
+        ((is_bulk_serializable<Fields>::value || is_wire_compatible<Fields>::value) && ...);
+    static constexpr size_t size = (sizeof(Fields) + ... + 0);
+};
+
+template <typename T, typename = void>
+struct has_packed_fields : std::false_type {};
+
+template <typename T>
+struct has_packed_fields<T, std::enable_if_t<has_fields<T>::value>>
+    : std::integral_constant<bool, packed_field_list<field_types_t<T>>::layout &&
+                                       packed_field_list<field_types_t<T>>::size == sizeof(T)> {};
+
+template <typename T>
+struct has_wire_layout
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                       (std::has_unique_object_representations<T>::value ||
+                                        has_packed_fields<T>::value)> {};
+
+// Wire compatible types are copied as raw bytes only in the native byte order; otherwise those
+// that declare their fields fall back to swapping field by field.
+template <typename T, typename Order>
+struct is_raw_copyable
+    : std::integral_constant<bool, is_wire_compatible<T>::value && !needs_byte_swap<Order>::value> {
+};
+
+}  // namespace detail
+
+template <typename T, typename StreamT>
+T read(StreamT& is);
+
 template <typename StreamT, typename T,
-          typename std::enable_if_t<std::is_integral<T>::value, int> = 0>
-void read(StreamT& is, T& val) {
+          typename std::enable_if_t<is_wire_compatible<T>::value && !has_fields<T>::value, int> = 0>
+void read(StreamT& is, T& val);
+
+template <typename StreamT, typename T,
+          typename std::enable_if_t<is_wire_compatible<T>::value && !has_fields<T>::value, int> = 0>
+void write(StreamT& os, const T& val);
+
+template <typename StreamT, typename T, typename std::enable_if_t<has_fields<T>::value, int> = 0>
+void read(StreamT& is, T& val);
+
+template <typename StreamT, typename T, typename std::enable_if_t<has_fields<T>::value, int> = 0>
+void write(StreamT& os, const T& val);
+
+template <typename StreamT, typename T, typename Alloc>
+void read(StreamT& is, std::vector<T, Alloc>& val);
+
+template <typename StreamT, typename T, typename Alloc>
+void write(StreamT& os, const std::vector<T, Alloc>& val);
+
+template <typename StreamT, typename T, size_t N>
+void read(StreamT& is, std::array<T, N>& val);
+
+template <typename StreamT, typename T, size_t N>
+void write(StreamT& os, const std::array<T, N>& val);
+
+template <typename StreamT, typename T, size_t N,
+          typename std::enable_if_t<!std::is_same<std::remove_cv_t<T>, char>::value, int> = 0>
+void read(StreamT& is, T (&val)[N]);
+
+template <typename StreamT, typename T, size_t N,
+          typename std::enable_if_t<!std::is_same<std::remove_cv_t<T>, char>::value, int> = 0>
+void write(StreamT& os, const T (&val)[N]);
+
+// Types whose serialized size does not depend on their value expose it as value.
+template <typename T, typename = void>
+struct fixed_serialized_size {};
+
+template <typename T, typename = void>
+struct is_fixed_size : std::false_type {};
+
+template <typename T>
+struct is_fixed_size<T, std::void_t<decltype(fixed_serialized_size<T>::value)>> : std::true_type {};
+
+namespace detail {
+
+template <typename FieldList, typename = void>
+struct fixed_field_list_size {};
+
+template <typename... Fields>
+struct fixed_field_list_size<type_list<Fields...>,
+                             std::enable_if_t<(is_fixed_size<Fields>::value && ...)>>
+    : std::integral_constant<size_t, (fixed_serialized_size<Fields>::value + ... + 0)> {};
+
+}  // namespace detail
+
+template <typename T>
+struct fixed_serialized_size<
+    T, std::enable_if_t<is_bulk_serializable<T>::value || is_wire_compatible<T>::value>>
+    : std::integral_constant<size_t, sizeof(T)> {};
+
+template <typename T, size_t N>
+struct fixed_serialized_size<std::array<T, N>, std::enable_if_t<is_fixed_size<T>::value>>
+    : std::integral_constant<size_t, N * fixed_serialized_size<T>::value> {};
+
+template <typename T, size_t N>
+struct fixed_serialized_size<
+    T[N],
+    std::enable_if_t<is_fixed_size<T>::value && !std::is_same<std::remove_cv_t<T>, char>::value>>
+    : std::integral_constant<size_t, N * fixed_serialized_size<T>::value> {};
+
+template <typename T>
+struct fixed_serialized_size<
+    T, std::enable_if_t<has_fields<T>::value && !is_wire_compatible<T>::value>>
+    : detail::fixed_field_list_size<detail::field_types_t<T>> {};
+
+namespace detail {
+
+template <typename T, typename Prefix>
+constexpr size_t minSerializedSize(Prefix);
+
+// Lower bound on the serialized size of a non-fixed size T whose strings carry the given length
+// prefix. Anything not covered below, such as a varint, takes at least one byte.
+template <typename T, typename Prefix, typename = void>
+struct min_serialized_size : std::integral_constant<size_t, 1> {};
+
+template <typename Traits, typename Alloc, typename Prefix>
+struct min_serialized_size<std::basic_string<char, Traits, Alloc>, Prefix>
+    : std::integral_constant<size_t, std::is_same<Prefix, prefix::varint>::value
+                                         ? 1
+                                         : sizeof(typename Prefix::type)> {};
+
+template <typename Traits, typename Alloc, typename Prefix>
+struct min_serialized_size<std::basic_string<char16_t, Traits, Alloc>, Prefix>
+    : std::integral_constant<size_t, sizeof(uint32_t)> {};
+
+template <typename T, typename Alloc, typename Prefix>
+struct min_serialized_size<std::vector<T, Alloc>, Prefix>
+    : std::integral_constant<size_t, sizeof(uint32_t)> {};
+
+template <typename T, size_t N, typename Prefix>
+struct min_serialized_size<std::array<T, N>, Prefix>
+    : std::integral_constant<size_t, N * minSerializedSize<T>(Prefix{})> {};
+
+template <typename T, size_t N, typename Prefix>
+struct min_serialized_size<T[N], Prefix>
+    : std::integral_constant<size_t, N * minSerializedSize<T>(Prefix{})> {};
+
+template <typename Prefix, typename... Fields>
+constexpr size_t minFieldListSize(type_list<Fields...>) {
+    return (minSerializedSize<Fields>(Prefix{}) + ... + 0);
+}
+
+template <typename T, typename Prefix>
+struct min_serialized_size<T, Prefix, std::enable_if_t<has_fields<T>::value>>
+    : std::integral_constant<size_t, minFieldListSize<Prefix>(field_types_t<T>{})> {};
+
+template <typename T, typename Prefix>
+constexpr size_t minSerializedSize(Prefix) {
+    if constexpr (is_fixed_size<T>::value) {
+        return fixed_serialized_size<T>::value;
+    } else {
+        return min_serialized_size<T, Prefix>::value;
+    }
+}
+
+// Lower bound on the serialized size of a T read from StreamT, used to check element counts
+// against the input.
+template <typename T, typename StreamT>
+constexpr size_t minSerializedSize() {
+    return minSerializedSize<T>(length_prefix_t<StreamT>{});
+}
+
+}  // namespace detail
+
+template <typename T, typename Alloc>
+size_t serialized_size(const std::vector<T, Alloc>& val);
+
+template <typename T, size_t N, typename std::enable_if_t<!is_fixed_size<T>::value, int> = 0>
+size_t serialized_size(const std::array<T, N>& val);
+
+template <typename T, size_t N,
+          typename std::enable_if_t<!is_fixed_size<T>::value &&
+                                        !std::is_same<std::remove_cv_t<T>, char>::value,
+                                    int> = 0>
+size_t serialized_size(const T (&val)[N]);
+
+template <typename T,
+          typename std::enable_if_t<has_fields<T>::value && !is_fixed_size<T>::value, int> = 0>
+size_t serialized_size(const T& val);
+
+template <typename StreamT, typename T, typename Order,
+          typename std::enable_if_t<std::is_arithmetic<T>::value && is_byte_order<Order>::value,
+                                    int> = 0>
+void read(StreamT& is, T& val, Order) {
     is.read(reinterpret_cast<char*>(&val), sizeof(T));
+
+    if constexpr (needs_byte_swap<Order>::value) {
+        val = detail::byteSwapValue(val);
+    }
+}
+
+template <typename StreamT, typename T, typename Order,
+          typename std::enable_if_t<std::is_arithmetic<T>::value && is_byte_order<Order>::value,
+                                    int> = 0>
+void write(StreamT& os, const T& val, Order) {
+    if constexpr (needs_byte_swap<Order>::value) {
+        T tmp = detail::byteSwapValue(val);
+        os.write(reinterpret_cast<const char*>(&tmp), sizeof(T));
+    } else {
+        os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
+}
+
+template <typename StreamT, typename T,
+          typename std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+void read(StreamT& is, T& val) {
+    read(is, val, byte_order_t<StreamT>{});
 }
 
 template <typename StreamT, typename T,
-          typename std::enable_if_t<std::is_integral<T>::value, int> = 0>
-void write(StreamT& os, T& val) {
-    os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+          typename std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+void write(StreamT& os, const T& val) {
+    write(os, val, byte_order_t<StreamT>{});
+}
+
+template <typename StreamT, typename T, typename Order,
+          typename std::enable_if_t<std::is_enum<T>::value && is_byte_order<Order>::value, int> = 0>
+void read(StreamT& is, T& val, Order) {
+    is.read(reinterpret_cast<char*>(&val), sizeof(T));
+
+    if constexpr (needs_byte_swap<Order>::value) {
+        val = detail::byteSwapValue(val);
+    }
+}
+
+template <typename StreamT, typename T, typename Order,
+          typename std::enable_if_t<std::is_enum<T>::value && is_byte_order<Order>::value, int> = 0>
+void write(StreamT& os, const T& val, Order) {
+    if constexpr (needs_byte_swap<Order>::value) {
+        T tmp = detail::byteSwapValue(val);
+        os.write(reinterpret_cast<const char*>(&tmp), sizeof(T));
+    } else {
+        os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
 }
 
 template <typename StreamT, typename T,
           typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
 void read(StreamT& is, T& val) {
-    is.read(reinterpret_cast<char*>(&val), sizeof(T));
+    read(is, val, byte_order_t<StreamT>{});
 }
 
 template <typename StreamT, typename T,
           typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
 void write(StreamT& os, const T& val) {
-    os.write(reinterpret_cast<const char*>(&val), sizeof(T));
+    write(os, val, byte_order_t<StreamT>{});
+}
+
+namespace detail {
+
+template <typename StreamT, typename Prefix>
+size_t readLength(StreamT& is, Prefix) {
+    if constexpr (std::is_same<Prefix, prefix::varint>::value) {
+        esb::varint<uint32_t> length;
+        read(is, length);
+        return length.value;
+    } else {
+        typename Prefix::type length = 0;
+        read(is, length);
+        return length;
+    }
+}
+
+// Writes the length prefix, or flags the stream and returns false if the length is not
+// representable with the given prefix.
+template <typename StreamT, typename Prefix>
+bool writeLength(StreamT& os, size_t length, Prefix) {
+    using length_type = typename Prefix::type;
+
+    if (length > std::numeric_limits<length_type>::max()) {
+        os.setstate(std::ios_base::failbit);
+        return false;
+    }
+
+    if constexpr (std::is_same<Prefix, prefix::varint>::value) {
+        write(os, esb::varint<length_type>{static_cast<length_type>(length)});
+    } else {
+        write(os, static_cast<length_type>(length));
+    }
+
+    return true;
+}
+
+}  // namespace detail
+
+namespace detail {
+
+template <typename StreamT, typename Traits, typename Alloc, typename Prefix>
+void readString(StreamT& is, std::basic_string<char, Traits, Alloc>& val, Prefix prefix,
+                size_t limit) {
+    auto length = readLength(is, prefix);
+
+    if (checkLength(is, length, 1, limit)) {
+        readResized(is, val, length, [&is, &val](size_t offset, size_t count) {
+            is.read(val.data() + offset, static_cast<std::streamsize>(count));
+            return !is.fail();
+        });
+    }
+}
+
+}  // namespace detail
+
+// Strings and vectors are read into whatever allocator they were constructed with, so decoding
+// into std::pmr::string and std::pmr::vector members sharing a std::pmr::monotonic_buffer_resource
+// places a whole message in one region that is released at once. Elements created by resize
+// inherit a polymorphic allocator, so nested containers end up in the same region.
+template <typename StreamT, typename Traits, typename Alloc, typename Prefix,
+          typename std::enable_if_t<is_length_prefix<Prefix>::value, int> = 0>
+void read(StreamT& is, std::basic_string<char, Traits, Alloc>& val, Prefix prefix) {
+    detail::readString(is, val, prefix, length_limit_of<StreamT>::value);
+}
+
+template <typename StreamT, typename Traits, typename Alloc>
+void read(StreamT& is, std::basic_string<char, Traits, Alloc>& val, length_limit limit) {
+    detail::readString(is, val, length_prefix_t<StreamT>{}, limit.value);
+}
+
+template <typename StreamT, typename Traits, typename Alloc>
+void read(StreamT& is, std::basic_string<char, Traits, Alloc>& val) {
+    read(is, val, length_prefix_t<StreamT>{});
+}
+
+// Borrows the string bytes directly from the stream without copying; the view remains valid only
+// as long as the memory underlying the stream does.
+template <typename StreamT, typename Prefix,
+          typename std::enable_if_t<is_contiguous_stream<StreamT>::value &&
+                                        is_length_prefix<Prefix>::value,
+                                    int> = 0>
+void read(StreamT& is, std::string_view& val, Prefix prefix) {
+    auto length = detail::readLength(is, prefix);
+
+    if (!detail::checkLength(is, length, 0, length_limit_of<StreamT>::value)) {
+        return;
+    }
+
+    if (auto data = is.consume(length)) {
+        val = std::string_view{data, length};
+    }
+}
+
+template <typename StreamT,
+          typename std::enable_if_t<is_contiguous_stream<StreamT>::value, int> = 0>
+void read(StreamT& is, std::string_view& val) {
+    read(is, val, length_prefix_t<StreamT>{});
+}
+
+// Strings too long for the length prefix are not written; the stream is flagged instead.
+template <typename StreamT, typename Prefix,
+          typename std::enable_if_t<is_length_prefix<Prefix>::value, int> = 0>
+void write(StreamT& os, std::string_view val, Prefix prefix) {
+    if (detail::writeLength(os, val.length(), prefix)) {
+        detail::writeBytes(os, val.data(), val.length());
+    }
 }
 
 template <typename StreamT>
-void read(StreamT& is, std::string& val) {
-    auto length = read<uint16_t>(is);
+void write(StreamT& os, std::string_view val) {
+    write(os, val, length_prefix_t<StreamT>{});
+}
+
+namespace detail {
+
+template <typename StreamT, typename T, typename Order>
+void readSequence(StreamT& is, T* data, size_t count, Order) {
+    if constexpr (is_raw_copyable<T, Order>::value) {
+        static_assert(has_wire_layout<T>::value, "is_wire_compatible type has padding");
+        is.read(reinterpret_cast<char*>(data), count * sizeof(T));
+    } else if constexpr (is_bulk_serializable<T>::value) {
+        is.read(reinterpret_cast<char*>(data), count * sizeof(T));
+
+        if constexpr (needs_byte_swap<Order>::value) {
+            byteSwapSequence<sizeof(T)>(reinterpret_cast<char*>(data), count);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            read(is, data[i]);
+        }
+    }
+}
+
+template <typename StreamT, typename T, typename Order>
+void writeSequence(StreamT& os, const T* data, size_t count, Order) {
+    if constexpr (is_bulk_serializable<T>::value && needs_byte_swap<Order>::value &&
+                  sizeof(T) > 1) {
+        // The source is const, so swap through a small staging buffer one chunk at a time.
+        constexpr size_t kChunkCount = 256 / sizeof(T);
+        T                chunk[kChunkCount];
+
+        while (count > 0) {
+            size_t chunkCount = count < kChunkCount ? count : kChunkCount;
+            std::memcpy(chunk, data, chunkCount * sizeof(T));
+            byteSwapSequence<sizeof(T)>(reinterpret_cast<char*>(chunk), chunkCount);
+            os.write(reinterpret_cast<const char*>(chunk), chunkCount * sizeof(T));
+
+            data += chunkCount;
+            count -= chunkCount;
+        }
+    } else if constexpr (is_raw_copyable<T, Order>::value) {
+        static_assert(has_wire_layout<T>::value, "is_wire_compatible type has padding");
+        writeBytes(os, reinterpret_cast<const char*>(data), count * sizeof(T));
+    } else if constexpr (is_bulk_serializable<T>::value) {
+        writeBytes(os, reinterpret_cast<const char*>(data), count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            write(os, data[i]);
+        }
+    }
+}
+
+}  // namespace detail
+
+// Vectors are prefixed with a uint32_t element count; fixed size arrays carry no prefix. Arrays of
+// arithmetic or enum elements can be given an explicit byte order, which then applies to both the
+// elements and the count. Reading into an existing vector decodes into its elements in place, so
+// the vector, and the strings and vectors within elements that survive the resize, keep their
+// capacity; only elements dropped by a shrinking resize are destroyed.
+template <typename StreamT, typename T, typename Alloc, typename Order,
+          typename std::enable_if_t<is_bulk_serializable<T>::value && is_byte_order<Order>::value,
+                                    int> = 0>
+void read(StreamT& is, std::vector<T, Alloc>& val, Order order) {
+    static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not supported");
+
+    uint32_t length = 0;
+    read(is, length, order);
+
+    if (detail::checkLength(is, length, sizeof(T), length_limit_of<StreamT>::value)) {
+        detail::readResized(is, val, length, [&is, &val, order](size_t offset, size_t count) {
+            detail::readSequence(is, val.data() + offset, count, order);
+            return !is.fail();
+        });
+    }
+}
+
+template <typename StreamT, typename T, typename Alloc, typename Order,
+          typename std::enable_if_t<is_bulk_serializable<T>::value && is_byte_order<Order>::value,
+                                    int> = 0>
+void write(StreamT& os, const std::vector<T, Alloc>& val, Order order) {
+    static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not supported");
+
+    uint32_t length = static_cast<uint32_t>(val.size());
+    write(os, length, order);
+
+    detail::writeSequence(os, val.data(), length, order);
+}
+
+template <typename StreamT, typename T, typename Alloc>
+void read(StreamT& is, std::vector<T, Alloc>& val, length_limit limit) {
+    static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not supported");
+
+    auto length = read<uint32_t>(is);
+
+    if (!detail::checkLength(is, length, detail::minSerializedSize<T, StreamT>(), limit.value)) {
+        return;
+    }
+
+    if constexpr (is_fixed_size<T>::value) {
+        detail::readResized(is, val, length, [&is, &val](size_t offset, size_t count) {
+            detail::readSequence(is, val.data() + offset, count, byte_order_t<StreamT>{});
+            return !is.fail();
+        });
+    } else {
+        // Elements are only created as they are reached, so a count that the input cannot back
+        // costs no more than the elements actually decoded before the read fails.
+        if (length < val.size()) {
+            val.resize(length);
+        }
+
+        for (uint32_t i = 0; i < length && !is.fail(); ++i) {
+            if (i == val.size()) {
+                val.resize(i + 1);
+            }
+
+            read(is, val[i]);
+        }
+    }
+}
+
+template <typename StreamT, typename T, typename Alloc>
+void read(StreamT& is, std::vector<T, Alloc>& val) {
+    read(is, val, length_limit{length_limit_of<StreamT>::value});
+}
+
+template <typename StreamT, typename T, typename Alloc>
+void write(StreamT& os, const std::vector<T, Alloc>& val) {
+    static_assert(!std::is_same<T, bool>::value, "std::vector<bool> is not supported");
+
+    uint32_t length = static_cast<uint32_t>(val.size());
+    write(os, length);
+
+    detail::writeSequence(os, val.data(), length, byte_order_t<StreamT>{});
+}
+
+template <typename StreamT, typename T, size_t N, typename Order,
+          typename std::enable_if_t<is_bulk_serializable<T>::value && is_byte_order<Order>::value,
+                                    int> = 0>
+void read(StreamT& is, std::array<T, N>& val, Order order) {
+    detail::readSequence(is, val.data(), N, order);
+}
+
+template <typename StreamT, typename T, size_t N, typename Order,
+          typename std::enable_if_t<is_bulk_serializable<T>::value && is_byte_order<Order>::value,
+                                    int> = 0>
+void write(StreamT& os, const std::array<T, N>& val, Order order) {
+    detail::writeSequence(os, val.data(), N, order);
+}
+
+template <typename StreamT, typename T, size_t N>
+void read(StreamT& is, std::array<T, N>& val) {
+    detail::readSequence(is, val.data(), N, byte_order_t<StreamT>{});
+}
+
+template <typename StreamT, typename T, size_t N>
+void write(StreamT& os, const std::array<T, N>& val) {
+    detail::writeSequence(os, val.data(), N, byte_order_t<StreamT>{});
+}
+
+template <typename StreamT, typename T, size_t N,
+          typename std::enable_if_t<!std::is_same<std::remove_cv_t<T>, char>::value, int>>
+void read(StreamT& is, T (&val)[N]) {
+    detail::readSequence(is, val, N, byte_order_t<StreamT>{});
+}
+
+template <typename StreamT, typename T, size_t N,
+          typename std::enable_if_t<!std::is_same<std::remove_cv_t<T>, char>::value, int>>
+void write(StreamT& os, const T (&val)[N]) {
+    detail::writeSequence(os, val, N, byte_order_t<StreamT>{});
+}
 
-    val.resize(length);
+// UTF-16 strings are prefixed with a uint32_t count of code units.
+template <typename StreamT, typename Traits, typename Alloc>
+void read(StreamT& is, std::basic_string<char16_t, Traits, Alloc>& val) {
+    auto length = read<uint32_t>(is);
 
-    is.read(val.data(), length);
+    if (detail::checkLength(is, length, sizeof(char16_t), length_limit_of<StreamT>::value)) {
+        detail::readResized(is, val, length, [&is, &val](size_t offset, size_t count) {
+            detail::readSequence(is, val.data() + offset, count, byte_order_t<StreamT>{});
+            return !is.fail();
+        });
+    }
 }
 
 template <typename StreamT>
-void write(StreamT& os, const std::string& val) {
-    uint16_t length = static_cast<uint16_t>(val.length());
+void write(StreamT& os, std::u16string_view val) {
+    if (val.length() > std::numeric_limits<uint32_t>::max()) {
+        os.setstate(std::ios_base::failbit);
+        return;
+    }
+
+    uint32_t length = static_cast<uint32_t>(val.length());
     write(os, length);
 
-    os.write(val.data(), length);
+    detail::writeSequence(os, val.data(), length, byte_order_t<StreamT>{});
+}
+
+// Fields are decoded in place, so a long lived message object that is read into repeatedly reuses
+// the capacity of its strings and containers and stops allocating once it has seen its largest
+// message.
+template <typename StreamT, typename T, typename std::enable_if_t<has_fields<T>::value, int>>
+void read(StreamT& is, T& val) {
+    if constexpr (detail::is_raw_copyable<T, byte_order_t<StreamT>>::value) {
+        detail::readSequence(is, &val, 1, byte_order_t<StreamT>{});
+    } else {
+        val.esbVisitFields([&is](auto&... fields) { (read(is, fields), ...); });
+    }
+}
+
+template <typename StreamT, typename T, typename std::enable_if_t<has_fields<T>::value, int>>
+void write(StreamT& os, const T& val) {
+    if constexpr (detail::is_raw_copyable<T, byte_order_t<StreamT>>::value) {
+        detail::writeSequence(os, &val, 1, byte_order_t<StreamT>{});
+    } else {
+        val.esbVisitFields([&os](const auto&... fields) { (write(os, fields), ...); });
+    }
+}
+
+// Wire compatible types without declared fields have no byte swapped form.
+template <typename StreamT, typename T,
+          typename std::enable_if_t<is_wire_compatible<T>::value && !has_fields<T>::value, int>>
+void read(StreamT& is, T& val) {
+    static_assert(!needs_byte_swap<byte_order_t<StreamT>>::value,
+                  "is_wire_compatible types need ESB_FIELDS for non-native byte orders");
+    detail::readSequence(is, &val, 1, byte_order_t<StreamT>{});
+}
+
+template <typename StreamT, typename T,
+          typename std::enable_if_t<is_wire_compatible<T>::value && !has_fields<T>::value, int>>
+void write(StreamT& os, const T& val) {
+    static_assert(!needs_byte_swap<byte_order_t<StreamT>>::value,
+                  "is_wire_compatible types need ESB_FIELDS for non-native byte orders");
+    detail::writeSequence(os, &val, 1, byte_order_t<StreamT>{});
+}
+
+// Number of bytes write produces for a value, computed without writing it: a compile time
+// constant for fixed size types and an exact count for strings and containers, so that output
+// buffers can be sized once and oversized packets rejected before they are encoded. Strings are
+// assumed to use the default uint16_t prefix unless another is passed; values that write would
+// reject, such as strings too long for their prefix, count as zero bytes. For other per-stream
+// policies, write the value to a CountingWriter declaring them instead.
+template <typename T>
+constexpr size_t serialized_size() {
+    return fixed_serialized_size<T>::value;
+}
+
+template <typename T, typename std::enable_if_t<is_fixed_size<T>::value, int> = 0>
+constexpr size_t serialized_size(const T&) {
+    return fixed_serialized_size<T>::value;
+}
+
+template <typename Prefix, typename std::enable_if_t<is_length_prefix<Prefix>::value, int> = 0>
+constexpr size_t serialized_size(std::string_view val, Prefix) {
+    using length_type = typename Prefix::type;
+
+    if (val.length() > std::numeric_limits<length_type>::max()) {
+        return 0;
+    }
+
+    if constexpr (std::is_same<Prefix, prefix::varint>::value) {
+        return serialized_size(esb::varint<length_type>{static_cast<length_type>(val.length())}) +
+               val.length();
+    } else {
+        return sizeof(length_type) + val.length();
+    }
+}
+
+constexpr size_t serialized_size(std::string_view val) {
+    return serialized_size(val, prefix::u16{});
+}
+
+constexpr size_t serialized_size(std::u16string_view val) {
+    if (val.length() > std::numeric_limits<uint32_t>::max()) {
+        return 0;
+    }
+
+    return sizeof(uint32_t) + val.length() * sizeof(char16_t);
+}
+
+template <typename T, typename Alloc>
+size_t serialized_size(const std::vector<T, Alloc>& val) {
+    if constexpr (is_fixed_size<T>::value) {
+        return sizeof(uint32_t) + val.size() * fixed_serialized_size<T>::value;
+    } else {
+        size_t size = sizeof(uint32_t);
+        for (const auto& element : val) {
+            size += serialized_size(element);
+        }
+        return size;
+    }
+}
+
+template <typename T, size_t N, typename std::enable_if_t<!is_fixed_size<T>::value, int>>
+size_t serialized_size(const std::array<T, N>& val) {
+    size_t size = 0;
+    for (const auto& element : val) {
+        size += serialized_size(element);
+    }
+    return size;
+}
+
+template <typename T, size_t N,
+          typename std::enable_if_t<!is_fixed_size<T>::value &&
+                                        !std::is_same<std::remove_cv_t<T>, char>::value,
+                                    int>>
+size_t serialized_size(const T (&val)[N]) {
+    size_t size = 0;
+    for (const auto& element : val) {
+        size += serialized_size(element);
+    }
+    return size;
+}
+
+template <typename T,
+          typename std::enable_if_t<has_fields<T>::value && !is_fixed_size<T>::value, int>>
+size_t serialized_size(const T& val) {
+    return val.esbVisitFields(
+        [](const auto&... fields) { return (serialized_size(fields) + ... + size_t{0}); });
 }
 
 template <typename T, typename StreamT>
 T read(StreamT& is) {
-    T tmp;
+    T tmp{};
     read(is, tmp);
     return tmp;
 }
+
+template <typename T, typename StreamT, typename Policy>
+T read(StreamT& is, Policy policy) {
+    T tmp{};
+    read(is, tmp, policy);
+    return tmp;
+}
+
+// For positional streams readAt and peekAt are pure reads through a temporary copy of the stream:
+// the cursor and state of `is` are left untouched, so they can be used on a const stream and from
+// several threads at once. A failed positional read is not reflected in the state of `is`. Other
+// streams are repositioned with seekg, leaving the cursor after the value read.
 template <typename T, typename StreamT>
 T readAt(StreamT& is, size_t offset) {
-    is.seekg(offset);
-    return read<T>(is);
+    if constexpr (is_positional_stream<std::remove_const_t<StreamT>>::value) {
+        std::remove_const_t<StreamT> tmp{is};
+        tmp.seekg(static_cast<std::streamoff>(offset));
+        return read<T>(tmp);
+    } else {
+        is.seekg(offset);
+        return read<T>(is);
+    }
 }
 
 template <typename T, typename StreamT>
 T peekAt(StreamT& is, size_t offset) {
-    auto pos = is.tellg();
-    T    val = readAt<T>(is, offset);
-    is.seekg(pos);
-    return val;
+    if constexpr (is_positional_stream<std::remove_const_t<StreamT>>::value) {
+        return readAt<T>(is, offset);
+    } else {
+        auto pos = is.tellg();
+        T    val = readAt<T>(is, offset);
+        is.seekg(pos);
+        return val;
+    }
+}
+
+namespace detail {
+
+// Stream over a fixed span of memory, through which a slot stores its value with the ordinary
+// write overloads.
+struct PatchWriter {
+    char* dst;
+
+    void write(const char* src, std::streamsize count) {
+        std::memcpy(dst, src, static_cast<size_t>(count));
+    }
+};
+
+}  // namespace detail
+
+// Placeholder for an arithmetic or enum value whose contents are only known after what follows it
+// has been written, such as a size or checksum. Filling it in writes exactly what write(os, val)
+// would have written in its place; on patchable streams that is a single store into the buffer,
+// other streams are briefly repositioned with seekp. A slot reserved on a failed stream is inert.
+template <typename T, typename StreamT, typename Order = byte_order_t<StreamT>>
+class slot {
+public:
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                  "only arithmetic and enum values can be reserved");
+
+    slot(StreamT& os, std::streampos pos)
+        : os_{&os}
+        , pos_{pos} {}
+
+    void set(const T& val) {
+        if (pos_ == std::streampos(-1)) {
+            return;
+        }
+
+        if constexpr (is_patchable_stream<StreamT>::value) {
+            detail::PatchWriter patch{os_->data() + static_cast<std::streamoff>(pos_)};
+            write(patch, val, Order{});
+        } else {
+            auto end = os_->tellp();
+            os_->seekp(pos_);
+            write(*os_, val, Order{});
+            os_->seekp(end);
+        }
+    }
+
+    // Position of the reserved bytes in the stream.
+    std::streampos position() const { return pos_; }
+
+private:
+    StreamT*       os_;
+    std::streampos pos_;
+};
+
+// Writes a zeroed placeholder for a T and returns the slot through which it is filled in later:
+//
+//     auto size = esb::reserve<uint32_t>(os);
+//     esb::write(os, body);
+//     size.set(bodySize);
+template <typename T, typename StreamT>
+slot<T, StreamT> reserve(StreamT& os) {
+    auto pos = os.fail() ? std::streampos(-1) : os.tellp();
+    write(os, T{});
+    return {os, os.fail() ? std::streampos(-1) : pos};
+}
+
+template <typename T, typename StreamT, typename Order,
+          typename std::enable_if_t<is_byte_order<Order>::value, int> = 0>
+slot<T, StreamT, Order> reserve(StreamT& os, Order) {
+    auto pos = os.fail() ? std::streampos(-1) : os.tellp();
+    write(os, T{}, Order{});
+    return {os, os.fail() ? std::streampos(-1) : pos};
 }
 
 }  // namespace esb
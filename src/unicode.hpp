@@ -0,0 +1,433 @@
+#pragma once
+
+#include "serialization.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ESB_UNICODE_SSE2 1
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace esb {
+
+// Wraps a UTF-8 std::string, or any other char std::basic_string, so that it is serialized as
+// UTF-16: a uint32_t count of code units followed by the code units, both in the stream byte
+// order, exactly like a std::u16string. The transcoding happens during read/write, validating the
+// input as it goes; malformed input flags the stream rather than being passed through.
+template <typename StringT>
+struct utf16_adapter {
+    StringT& value;
+};
+
+template <typename Traits, typename Alloc>
+utf16_adapter<std::basic_string<char, Traits, Alloc>> as_utf16(
+    std::basic_string<char, Traits, Alloc>& val) {
+    return {val};
+}
+
+template <typename Traits, typename Alloc>
+utf16_adapter<const std::basic_string<char, Traits, Alloc>> as_utf16(
+    const std::basic_string<char, Traits, Alloc>& val) {
+    return {val};
+}
+
+namespace detail {
+
+constexpr size_t kInvalidUtf8 = static_cast<size_t>(-1);
+
+// Decodes one code point from [src, end), which must not be empty, advancing src past it. Rejects
+// truncated and overlong sequences, surrogates and values beyond U+10FFFF by returning false.
+inline bool decodeUtf8(const uint8_t*& src, const uint8_t* end, uint32_t& codePoint) {
+    uint8_t lead = *src;
+
+    if (lead < 0x80) {
+        codePoint = lead;
+        ++src;
+        return true;
+    }
+
+    size_t   length;
+    uint32_t minimum;
+    if ((lead & 0xE0) == 0xC0) {
+        length    = 2;
+        minimum   = 0x80;
+        codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length    = 3;
+        minimum   = 0x800;
+        codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length    = 4;
+        minimum   = 0x10000;
+        codePoint = lead & 0x07;
+    } else {
+        return false;
+    }
+
+    if (static_cast<size_t>(end - src) < length) {
+        return false;
+    }
+
+    for (size_t i = 1; i < length; ++i) {
+        if ((src[i] & 0xC0) != 0x80) {
+            return false;
+        }
+        codePoint = (codePoint << 6) | (src[i] & 0x3F);
+    }
+
+    if (codePoint < minimum || codePoint > 0x10FFFF ||
+        (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        return false;
+    }
+
+    src += length;
+    return true;
+}
+
+#if defined(ESB_UNICODE_SSE2)
+// Two byte sequences cover U+0080 to U+07FF, which holds accented Latin, Greek, Cyrillic, Hebrew
+// and Arabic. A run of them is vectorized 8 sequences at a time, each read as a little endian 16
+// bit lane with the lead byte low. Three byte sequences, such as CJK text, and blocks mixing
+// sequence lengths take the scalar path.
+inline bool isUtf8TwoByteBlock(__m128i lanes) {
+    const __m128i pattern = _mm_set1_epi16(static_cast<short>(0x80C0));
+    const __m128i mask    = _mm_set1_epi16(static_cast<short>(0xC0E0));
+    const __m128i payload = _mm_set1_epi16(0x001E);
+
+    // Lead bytes C0 and C1 only start overlong encodings.
+    __m128i matches  = _mm_cmpeq_epi16(_mm_and_si128(lanes, mask), pattern);
+    __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(lanes, payload), _mm_setzero_si128());
+    return _mm_movemask_epi8(_mm_andnot_si128(overlong, matches)) == 0xFFFF;
+}
+
+inline __m128i decodeUtf8TwoByteBlock(__m128i lanes) {
+    __m128i high = _mm_slli_epi16(_mm_and_si128(lanes, _mm_set1_epi16(0x001F)), 6);
+    __m128i low  = _mm_and_si128(_mm_srli_epi16(lanes, 8), _mm_set1_epi16(0x003F));
+    return _mm_or_si128(high, low);
+}
+
+inline bool isUtf16TwoByteBlock(__m128i units) {
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i above = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+
+    __m128i below800 = _mm_cmpeq_epi16(_mm_and_si128(units, above), zero);
+    __m128i below80  = _mm_cmpeq_epi16(_mm_and_si128(units, ascii), zero);
+    return _mm_movemask_epi8(_mm_andnot_si128(below80, below800)) == 0xFFFF;
+}
+
+inline __m128i encodeUtf8TwoByteBlock(__m128i units) {
+    __m128i lead         = _mm_or_si128(_mm_srli_epi16(units, 6), _mm_set1_epi16(0x00C0));
+    __m128i continuation = _mm_slli_epi16(_mm_and_si128(units, _mm_set1_epi16(0x003F)), 8);
+    continuation         = _mm_or_si128(continuation, _mm_set1_epi16(static_cast<short>(0x8000)));
+    return _mm_or_si128(lead, continuation);
+}
+#endif
+
+// Validates a UTF-8 sequence and returns the number of UTF-16 code units it transcodes to, or
+// kInvalidUtf8. ASCII runs and runs of two byte sequences are skipped 16 bytes at a time.
+inline size_t utf16Length(const char* data, size_t size) {
+    auto   src    = reinterpret_cast<const uint8_t*>(data);
+    auto   end    = src + size;
+    size_t length = 0;
+
+    while (src != end) {
+#if defined(ESB_UNICODE_SSE2)
+        while (end - src >= 16 &&
+               _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))) == 0) {
+            src += 16;
+            length += 16;
+        }
+
+        while (end - src >= 16 &&
+               isUtf8TwoByteBlock(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)))) {
+            src += 16;
+            length += 8;
+        }
+
+        if (src == end) {
+            break;
+        }
+#endif
+
+        uint32_t codePoint;
+        if (!decodeUtf8(src, end, codePoint)) {
+            return kInvalidUtf8;
+        }
+
+        length += codePoint >= 0x10000 ? 2 : 1;
+    }
+
+    return length;
+}
+
+// Transcodes previously validated UTF-8 from [src, end) into at most capacity code units at dst,
+// advancing src, and returns the number of code units written. Stops early rather than splitting a
+// surrogate pair across calls.
+inline size_t utf8ToUtf16(const char*& src, const char* end, char16_t* dst, size_t capacity) {
+    auto   ptr  = reinterpret_cast<const uint8_t*>(src);
+    auto   last = reinterpret_cast<const uint8_t*>(end);
+    size_t out  = 0;
+
+    while (ptr != last && out < capacity) {
+#if defined(__AVX2__)
+        while (last - ptr >= 32 && capacity - out >= 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+            if (_mm256_movemask_epi8(bytes) != 0) {
+                break;
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + out),
+                                _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + out + 16),
+                                _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+            ptr += 32;
+            out += 32;
+        }
+#endif
+
+#if defined(ESB_UNICODE_SSE2)
+        while (last - ptr >= 16 && capacity - out >= 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+            if (_mm_movemask_epi8(bytes) != 0) {
+                break;
+            }
+
+            const __m128i zero = _mm_setzero_si128();
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out + 8),
+                             _mm_unpackhi_epi8(bytes, zero));
+            ptr += 16;
+            out += 16;
+        }
+
+        while (last - ptr >= 16 && capacity - out >= 8) {
+            __m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+            if (!isUtf8TwoByteBlock(lanes)) {
+                break;
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out), decodeUtf8TwoByteBlock(lanes));
+            ptr += 16;
+            out += 8;
+        }
+
+        if (ptr == last || out == capacity) {
+            break;
+        }
+#endif
+
+        auto     next      = ptr;
+        uint32_t codePoint = 0;
+        decodeUtf8(next, last, codePoint);
+
+        if (codePoint >= 0x10000) {
+            if (capacity - out < 2) {
+                break;
+            }
+
+            codePoint -= 0x10000;
+            dst[out++] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            dst[out++] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        } else {
+            dst[out++] = static_cast<char16_t>(codePoint);
+        }
+
+        ptr = next;
+    }
+
+    src = reinterpret_cast<const char*>(ptr);
+    return out;
+}
+
+// Transcodes count UTF-16 code units to UTF-8 at dst, which must have room for 3 bytes per code
+// unit, and returns the number of bytes written. A high surrogate at the end of the input is
+// carried in pending so that pairs split across calls are joined. Returns kInvalidUtf8 on unpaired
+// surrogates.
+inline size_t utf16ToUtf8(const char16_t* src, size_t count, char* dst, char16_t& pending) {
+    size_t in  = 0;
+    size_t out = 0;
+
+    while (in < count) {
+#if defined(ESB_UNICODE_SSE2)
+        if (pending == 0) {
+            const __m128i highBits = _mm_set1_epi16(static_cast<short>(0xFF80));
+            const __m128i zero     = _mm_setzero_si128();
+
+            while (count - in >= 8) {
+                __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + in));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, highBits), zero)) !=
+                    0xFFFF) {
+                    break;
+                }
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + out),
+                                 _mm_packus_epi16(units, zero));
+                in += 8;
+                out += 8;
+            }
+
+            while (count - in >= 8) {
+                __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + in));
+                if (!isUtf16TwoByteBlock(units)) {
+                    break;
+                }
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + out),
+                                 encodeUtf8TwoByteBlock(units));
+                in += 8;
+                out += 16;
+            }
+
+            if (in == count) {
+                break;
+            }
+        }
+#endif
+
+        uint32_t unit = src[in++];
+
+        if (pending != 0) {
+            if (unit < 0xDC00 || unit > 0xDFFF) {
+                return kInvalidUtf8;
+            }
+
+            unit    = 0x10000 + ((static_cast<uint32_t>(pending) - 0xD800) << 10) + (unit - 0xDC00);
+            pending = 0;
+        } else if (unit >= 0xD800 && unit <= 0xDBFF) {
+            pending = static_cast<char16_t>(unit);
+            continue;
+        } else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+            return kInvalidUtf8;
+        }
+
+        auto bytes = reinterpret_cast<uint8_t*>(dst);
+        if (unit < 0x80) {
+            bytes[out++] = static_cast<uint8_t>(unit);
+        } else if (unit < 0x800) {
+            bytes[out++] = static_cast<uint8_t>(0xC0 | (unit >> 6));
+            bytes[out++] = static_cast<uint8_t>(0x80 | (unit & 0x3F));
+        } else if (unit < 0x10000) {
+            bytes[out++] = static_cast<uint8_t>(0xE0 | (unit >> 12));
+            bytes[out++] = static_cast<uint8_t>(0x80 | ((unit >> 6) & 0x3F));
+            bytes[out++] = static_cast<uint8_t>(0x80 | (unit & 0x3F));
+        } else {
+            // The four byte encoding covers two code units, so it fits within their 6 byte budget.
+            bytes[out++] = static_cast<uint8_t>(0xF0 | (unit >> 18));
+            bytes[out++] = static_cast<uint8_t>(0x80 | ((unit >> 12) & 0x3F));
+            bytes[out++] = static_cast<uint8_t>(0x80 | ((unit >> 6) & 0x3F));
+            bytes[out++] = static_cast<uint8_t>(0x80 | (unit & 0x3F));
+        }
+    }
+
+    return out;
+}
+
+constexpr size_t kUtf16ChunkSize = 256;
+
+}  // namespace detail
+
+template <typename StringT>
+size_t serialized_size(utf16_adapter<StringT> val) {
+    auto length = detail::utf16Length(val.value.data(), val.value.size());
+
+    if (length == detail::kInvalidUtf8 || length > std::numeric_limits<uint32_t>::max()) {
+        return 0;
+    }
+
+    return sizeof(uint32_t) + length * sizeof(char16_t);
+}
+
+namespace detail {
+
+// Transcodes count UTF-16 code units from the stream into str, once the count has been read and
+// checked. Each chunk is transcoded into a staging buffer and appended, so the string is never
+// zero filled. When the count has been checked against the bytes remaining, the first chunk
+// reserves its exact size plus one byte per code unit still to come, the size of ASCII text, and
+// wider text grows the string as it goes.
+template <typename StreamT, typename StringT>
+void readUtf16(StreamT& is, StringT& str, uint32_t count) {
+    str.clear();
+
+    // A pair split across chunks is written with the second chunk, one byte over its budget.
+    char16_t units[kUtf16ChunkSize];
+    char     bytes[kUtf16ChunkSize * 3 + 1];
+    char16_t pending = 0;
+
+    while (count > 0) {
+        size_t chunk = count < kUtf16ChunkSize ? count : kUtf16ChunkSize;
+        readSequence(is, units, chunk, byte_order_t<StreamT>{});
+
+        auto written = is.fail() ? kInvalidUtf8 : utf16ToUtf8(units, chunk, bytes, pending);
+        if (written == kInvalidUtf8) {
+            str.clear();
+            is.setstate(std::ios_base::failbit);
+            return;
+        }
+
+        if constexpr (has_remaining<StreamT>::value) {
+            if (str.empty()) {
+                str.reserve(written + (count - chunk));
+            }
+        }
+
+        str.append(bytes, written);
+        count -= static_cast<uint32_t>(chunk);
+    }
+
+    if (pending != 0) {
+        str.clear();
+        is.setstate(std::ios_base::failbit);
+    }
+}
+
+}  // namespace detail
+
+template <typename StreamT, typename StringT,
+          typename std::enable_if_t<!std::is_const<StringT>::value, int> = 0>
+void read(StreamT& is, utf16_adapter<StringT> val) {
+    auto count = read<uint32_t>(is);
+    if (detail::checkLength(is, count, sizeof(char16_t), length_limit_of<StreamT>::value)) {
+        detail::readUtf16(is, val.value, count);
+    }
+}
+
+template <typename StreamT, typename StringT>
+void write(StreamT& os, utf16_adapter<StringT> val) {
+    const auto& str    = val.value;
+    auto        length = detail::utf16Length(str.data(), str.size());
+
+    if (length == detail::kInvalidUtf8 || length > std::numeric_limits<uint32_t>::max()) {
+        os.setstate(std::ios_base::failbit);
+        return;
+    }
+
+    write(os, static_cast<uint32_t>(length));
+
+    char16_t    units[detail::kUtf16ChunkSize];
+    const char* src = str.data();
+    const char* end = src + str.size();
+
+    while (src != end) {
+        auto chunk = detail::utf8ToUtf16(src, end, units, detail::kUtf16ChunkSize);
+
+        // The units are a local staging buffer, so swap them in place and always copy them out.
+        if constexpr (needs_byte_swap<byte_order_t<StreamT>>::value) {
+            detail::byteSwapSequence<sizeof(char16_t)>(reinterpret_cast<char*>(units), chunk);
+        }
+        os.write(reinterpret_cast<const char*>(units),
+                 static_cast<std::streamsize>(chunk * sizeof(char16_t)));
+    }
+}
+
+}  // namespace esb
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <limits>
+#include <type_traits>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define ESB_VARINT_SSSE3 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace esb {
+
+// Wraps an unsigned integral so that it is serialized as a LEB128 variable length integer: seven
+// bits per byte, least significant group first, with the high bit set on every byte but the last.
+template <typename T>
+struct varint {
+    static_assert(std::is_unsigned<T>::value && !std::is_same<T, bool>::value,
+                  "varint requires an unsigned integral type");
+
+    varint() = default;
+    constexpr varint(T v)
+        : value{v} {}
+
+    constexpr operator T() const { return value; }
+
+    T value = 0;
+};
+
+// Wraps a signed integral so that it is zigzag mapped to an unsigned value (0, -1, 1, -2, ... to
+// 0, 1, 2, 3, ...) and then serialized as a varint, keeping small negative values small.
+template <typename T>
+struct zigzag {
+    static_assert(std::is_signed<T>::value && std::is_integral<T>::value,
+                  "zigzag requires a signed integral type");
+
+    zigzag() = default;
+    constexpr zigzag(T v)
+        : value{v} {}
+
+    constexpr operator T() const { return value; }
+
+    T value = 0;
+};
+
+// Largest number of bytes a varint encoding of T can occupy.
+template <typename T>
+constexpr size_t max_varint_size() {
+    return (std::numeric_limits<std::make_unsigned_t<T>>::digits + 6) / 7;
+}
+
+template <typename T>
+constexpr std::make_unsigned_t<T> zigzagEncode(T val) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<U>((static_cast<U>(val) << 1) ^
+                          static_cast<U>(val >> (std::numeric_limits<U>::digits - 1)));
+}
+
+template <typename T>
+constexpr T zigzagDecode(std::make_unsigned_t<T> val) {
+    using U = std::make_unsigned_t<T>;
+    return static_cast<T>((val >> 1) ^ static_cast<U>(0 - (val & 1)));
+}
+
+// Encodes val into dst, which must have room for max_varint_size<T>() bytes, and returns the
+// number of bytes written.
+template <typename T>
+size_t encodeVarint(T val, char* dst) {
+    static_assert(std::is_unsigned<T>::value, "encodeVarint requires an unsigned integral type");
+
+    size_t length = 0;
+    while (val >= 0x80) {
+        dst[length++] = static_cast<char>(static_cast<uint8_t>(val) | 0x80);
+        val >>= 7;
+    }
+    dst[length++] = static_cast<char>(val);
+
+    return length;
+}
+
+// Decodes a single varint from [src, end), advancing src past it. Fails on truncated input and on
+// encodings that do not fit in T.
+template <typename T>
+bool decodeVarint(const char*& src, const char* end, T& val) {
+    static_assert(std::is_unsigned<T>::value, "decodeVarint requires an unsigned integral type");
+
+    constexpr unsigned kDigits = std::numeric_limits<T>::digits;
+
+    T        result = 0;
+    unsigned shift  = 0;
+    auto     ptr    = reinterpret_cast<const uint8_t*>(src);
+    auto     last   = reinterpret_cast<const uint8_t*>(end);
+
+    while (ptr != last) {
+        uint8_t byte = *ptr++;
+        T       bits = static_cast<T>(byte & 0x7F);
+
+        if (kDigits - shift < 7 && (bits >> (kDigits - shift)) != 0) {
+            return false;
+        }
+
+        result |= static_cast<T>(bits << shift);
+
+        if ((byte & 0x80) == 0) {
+            src = reinterpret_cast<const char*>(ptr);
+            val = result;
+            return true;
+        }
+
+        shift += 7;
+        if (shift >= kDigits) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+namespace detail {
+
+#if defined(ESB_VARINT_SSSE3)
+// Shuffle tables for decoding up to four varints of one to three bytes at once, keyed by the
+// continuation bits of the next 12 input bytes. Each entry gathers the bytes of every complete
+// value within those 12 bytes into its own 32 bit lane, zero filled, and records how many values
+// that is and how many bytes they span.
+struct varint_shuffle_tables {
+    uint8_t shuffles[4096][16];
+    uint8_t counts[4096];
+    uint8_t lengths[4096];
+};
+
+inline varint_shuffle_tables makeVarintShuffleTables() {
+    varint_shuffle_tables tables{};
+
+    for (unsigned key = 0; key < 4096; ++key) {
+        unsigned pos   = 0;
+        unsigned count = 0;
+
+        for (unsigned lane = 0; lane < 4; ++lane) {
+            for (unsigned byte = 0; byte < 4; ++byte) {
+                tables.shuffles[key][lane * 4 + byte] = 0x80;
+            }
+        }
+
+        while (count < 4) {
+            unsigned length = 0;
+            while (length < 3 && pos + length < 12 && ((key >> (pos + length)) & 1) != 0) {
+                ++length;
+            }
+
+            if (length == 3 || pos + length == 12) {
+                break;
+            }
+
+            for (unsigned byte = 0; byte <= length; ++byte) {
+                tables.shuffles[key][count * 4 + byte] = static_cast<uint8_t>(pos + byte);
+            }
+
+            pos += length + 1;
+            ++count;
+        }
+
+        tables.counts[key]  = static_cast<uint8_t>(count);
+        tables.lengths[key] = static_cast<uint8_t>(pos);
+    }
+
+    return tables;
+}
+
+// The tables are built on first use rather than at compile time, which would cost seconds in
+// every translation unit including this header.
+inline const varint_shuffle_tables& varintShuffleTables() {
+    static const varint_shuffle_tables tables = makeVarintShuffleTables();
+    return tables;
+}
+
+// Decodes the complete one to three byte values at the start of 16 readable bytes at src into
+// four 32 bit lanes, returning how many values and, through length, bytes were decoded.
+inline unsigned decodeVarintLanes(const varint_shuffle_tables& tables, const char* src,
+                                  __m128i& lanes, unsigned& length) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    auto    key   = static_cast<unsigned>(_mm_movemask_epi8(bytes)) & 0xFFF;
+
+    __m128i shuffle = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(tables.shuffles[key]));
+    __m128i gathered = _mm_shuffle_epi8(bytes, shuffle);
+
+    __m128i low  = _mm_and_si128(gathered, _mm_set1_epi32(0x7F));
+    __m128i mid  = _mm_and_si128(_mm_srli_epi32(gathered, 1), _mm_set1_epi32(0x7F << 7));
+    __m128i high = _mm_and_si128(_mm_srli_epi32(gathered, 2), _mm_set1_epi32(0x7F << 14));
+    lanes        = _mm_or_si128(low, _mm_or_si128(mid, high));
+
+    length = tables.lengths[key];
+    return tables.counts[key];
+}
+
+// Stores the four lanes at dst, widened to T.
+template <typename T>
+void storeVarintLanes(__m128i lanes, T* dst) {
+    if constexpr (sizeof(T) == 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), lanes);
+    } else {
+        const __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi32(lanes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2), _mm_unpackhi_epi32(lanes, zero));
+    }
+}
+#endif
+
+}  // namespace detail
+
+// Decodes count consecutive varints from [src, src + size) into out and returns the number of
+// bytes consumed, or 0 if the input is truncated or malformed. With SSSE3, 32 and 64 bit values
+// of up to three bytes, which covers ids and deltas below 2^21, are decoded four at a time with a
+// table driven byte shuffle in the style of Masked VByte; longer values and the tail of the input
+// are decoded one at a time.
+template <typename T>
+size_t decodeVarints(const char* src, size_t size, T* out, size_t count) {
+    static_assert(std::is_unsigned<T>::value, "decodeVarints requires an unsigned integral type");
+
+    const char* ptr = src;
+    const char* end = src + size;
+    size_t      i   = 0;
+
+#if defined(ESB_VARINT_SSSE3)
+    if constexpr (sizeof(T) >= 4) {
+        const auto& tables = detail::varintShuffleTables();
+
+        while (count - i >= 4 && end - ptr >= 16) {
+            __m128i  lanes;
+            unsigned length = 0;
+            unsigned values = detail::decodeVarintLanes(tables, ptr, lanes, length);
+
+            if (values == 0) {
+                if (!decodeVarint(ptr, end, out[i++])) {
+                    return 0;
+                }
+                continue;
+            }
+
+            detail::storeVarintLanes(lanes, out + i);
+            ptr += length;
+            i += values;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        if (!decodeVarint(ptr, end, out[i])) {
+            return 0;
+        }
+    }
+
+    return static_cast<size_t>(ptr - src);
+}
+
+// Signed counterpart of decodeVarints for zigzag encoded values.
+template <typename T>
+size_t decodeZigzags(const char* src, size_t size, T* out, size_t count) {
+    static_assert(std::is_signed<T>::value, "decodeZigzags requires a signed integral type");
+
+    using U       = std::make_unsigned_t<T>;
+    auto values   = reinterpret_cast<U*>(out);
+    auto consumed = decodeVarints(src, size, values, count);
+
+    for (size_t i = 0; consumed != 0 && i < count; ++i) {
+        out[i] = zigzagDecode<T>(values[i]);
+    }
+
+    return consumed;
+}
+
+template <typename T>
+constexpr size_t serialized_size(const varint<T>& val) {
+    size_t size = 1;
+    for (T bits = val.value; bits >= 0x80; bits >>= 7) {
+        ++size;
+    }
+    return size;
+}
+
+template <typename T>
+constexpr size_t serialized_size(const zigzag<T>& val) {
+    return serialized_size(varint<std::make_unsigned_t<T>>{zigzagEncode(val.value)});
+}
+
+template <typename StreamT, typename T>
+void read(StreamT& is, varint<T>& val) {
+    T        result = 0;
+    unsigned shift  = 0;
+
+    for (size_t i = 0; i < max_varint_size<T>(); ++i, shift += 7) {
+        char byte = 0;
+        is.read(&byte, 1);
+
+        if (is.fail()) {
+            return;
+        }
+
+        T bits = static_cast<T>(static_cast<uint8_t>(byte) & 0x7F);
+        if (std::numeric_limits<T>::digits - shift < 7 &&
+            (bits >> (std::numeric_limits<T>::digits - shift)) != 0) {
+            break;
+        }
+
+        result |= static_cast<T>(bits << shift);
+
+        if ((byte & 0x80) == 0) {
+            val.value = result;
+            return;
+        }
+    }
+
+    is.setstate(std::ios_base::failbit);
+}
+
+template <typename StreamT, typename T>
+void write(StreamT& os, const varint<T>& val) {
+    char buffer[max_varint_size<T>()];
+    os.write(buffer, static_cast<std::streamsize>(encodeVarint(val.value, buffer)));
+}
+
+template <typename StreamT, typename T>
+void read(StreamT& is, zigzag<T>& val) {
+    varint<std::make_unsigned_t<T>> tmp;
+    read(is, tmp);
+    val.value = zigzagDecode<T>(tmp.value);
+}
+
+template <typename StreamT, typename T>
+void write(StreamT& os, const zigzag<T>& val) {
+    write(os, varint<std::make_unsigned_t<T>>{zigzagEncode(val.value)});
+}
+
+}  // namespace esb
@@ -0,0 +1,100 @@
+#include "buffer_reader.hpp"
+#include "buffer_writer.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+size_t allocationCount = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++allocationCount;
+
+    if (void* ptr = std::malloc(size != 0 ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+struct Item {
+    std::string name;
+    uint16_t    count;
+
+    ESB_FIELDS(name, count)
+};
+
+struct InventoryUpdate {
+    uint64_t              player;
+    std::string           note;
+    std::vector<uint32_t> removed;
+    std::vector<Item>     items;
+    std::u16string        title;
+
+    ESB_FIELDS(player, note, removed, items, title)
+};
+
+std::string serialize(const InventoryUpdate& update) {
+    esb::BufferWriter writer;
+    esb::write(writer, update);
+    return {writer.data(), writer.size()};
+}
+
+}  // namespace
+
+SCENARIO("decoding into existing objects reuses their capacity", "[allocations]") {
+    GIVEN("packets of varying length and a long lived message object") {
+        std::string longName(100, 'x');
+        std::string packets[] = {
+            serialize({1, "short", {1}, {{"a", 1}, {"b", 2}}, u"t"}),
+            serialize({2, longName, {1, 2, 3, 4, 5, 6, 7, 8}, {{longName, 3}, {longName, 4}},
+                       std::u16string(100, u'y')}),
+        };
+
+        InventoryUpdate update;
+
+        WHEN("the packets are decoded into the same object over and over") {
+            for (auto& packet : packets) {
+                esb::BufferReader reader{packet};
+                esb::read(reader, update);
+            }
+
+            size_t warmedUp = allocationCount;
+            bool   decoded  = true;
+
+            for (size_t i = 0; i < 1000000; ++i) {
+                auto&             packet = packets[i % 2];
+                esb::BufferReader reader{packet};
+                esb::read(reader, update);
+                decoded = decoded && reader.good() && update.player == i % 2 + 1;
+            }
+
+            size_t allocations = allocationCount - warmedUp;
+
+            THEN("no allocations happen after the first decode of each shape") {
+                REQUIRE(decoded);
+                REQUIRE(allocations == 0);
+                REQUIRE(update.items[1].name == longName);
+            }
+        }
+    }
+}
@@ -0,0 +1,341 @@
+#include "buffer_reader.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+SCENARIO("buffer readers can be used to deserialize values", "[buffer_reader]") {
+    GIVEN("a buffer containing serialized integral and string values") {
+        std::ostringstream os{std::stringstream::binary};
+
+        uint32_t    expectedInt = 0xDEADBEEF;
+        std::string expectedStr = "Some string value";
+        esb::write(os, expectedInt);
+        esb::write(os, expectedStr);
+
+        auto              bytes = os.str();
+        esb::BufferReader reader{bytes.data(), bytes.size()};
+
+        WHEN("the values are read from the buffer") {
+            auto tmpInt = esb::read<uint32_t>(reader);
+            auto tmpStr = esb::read<std::string>(reader);
+
+            THEN("the values read match the values written") {
+                REQUIRE(tmpInt == expectedInt);
+                REQUIRE(tmpStr == expectedStr);
+            }
+
+            AND_THEN("the entire buffer has been consumed") {
+                REQUIRE(reader.remaining() == 0);
+                REQUIRE(reader.good());
+            }
+        }
+
+        WHEN("a value is peeked from the buffer") {
+            esb::read<uint32_t>(reader);
+            auto length = esb::peekAt<uint16_t>(reader, 4);
+
+            THEN("the value is read from the requested offset") {
+                REQUIRE(length == expectedStr.length());
+            }
+
+            AND_THEN("the read position is unchanged") { REQUIRE(reader.position() == 4); }
+        }
+
+        WHEN("a value is read at a specific offset") {
+            auto tmpStr = esb::readAt<std::string>(reader, 4);
+
+            THEN("the value read matches the value written") { REQUIRE(tmpStr == expectedStr); }
+
+            AND_THEN("the read position is unchanged") { REQUIRE(reader.position() == 0); }
+        }
+
+        WHEN("a value is peeked from a const reader") {
+            const esb::BufferReader& constReader = reader;
+            auto                     tmpInt      = esb::peekAt<uint32_t>(constReader, 0);
+
+            THEN("the value read matches the value written") { REQUIRE(tmpInt == expectedInt); }
+        }
+
+        WHEN("a value is peeked beyond the end of the buffer") {
+            esb::peekAt<uint32_t>(reader, bytes.size() - 2);
+
+            THEN("the reader is unaffected") {
+                REQUIRE(reader.good());
+                REQUIRE(reader.position() == 0);
+            }
+        }
+    }
+
+    GIVEN("a buffer containing an empty vector") {
+        const char        bytes[] = {0x00, 0x00, 0x00, 0x00};
+        esb::BufferReader reader{bytes, sizeof(bytes)};
+
+        WHEN("the vector is read") {
+            auto tmp = esb::read<std::vector<uint32_t>>(reader);
+
+            THEN("it is read without touching its storage") {
+                REQUIRE(tmp.empty());
+                REQUIRE(tmp.capacity() == 0);
+                REQUIRE(reader.good());
+                REQUIRE(reader.remaining() == 0);
+            }
+        }
+    }
+
+    GIVEN("a buffer that is shorter than the value being read") {
+        const std::byte bytes[] = {std::byte{0x01}, std::byte{0x02}};
+        esb::BufferReader reader{bytes, sizeof(bytes)};
+
+        WHEN("a 32 bit value is read from the buffer") {
+            uint32_t tmp = 0;
+            esb::read(reader, tmp);
+
+            THEN("the reader reports the failure") {
+                REQUIRE(reader.fail());
+                REQUIRE(reader.eof());
+                REQUIRE(reader.gcount() == 2);
+            }
+        }
+    }
+}
+
+SCENARIO("buffer readers can lend out strings without copying", "[buffer_reader]") {
+    GIVEN("a buffer containing a serialized string") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, std::string_view{"command"});
+
+        auto              bytes = os.str();
+        esb::BufferReader reader{bytes.data(), bytes.size()};
+
+        WHEN("the string is read as a string view") {
+            auto tmp = esb::read<std::string_view>(reader);
+
+            THEN("the view refers to the bytes in the buffer") {
+                REQUIRE(tmp == "command");
+                REQUIRE(tmp.data() == bytes.data() + sizeof(uint16_t));
+                REQUIRE(reader.remaining() == 0);
+            }
+        }
+    }
+
+    GIVEN("a buffer with a string length that exceeds the remaining bytes") {
+        const char        bytes[] = {0x10, 0x00, 'a', 'b'};
+        esb::BufferReader reader{bytes, sizeof(bytes)};
+
+        WHEN("the string is read as a string view") {
+            std::string_view tmp;
+            esb::read(reader, tmp);
+
+            THEN("the view is left empty and the reader reports the failure") {
+                REQUIRE(tmp.empty());
+                REQUIRE(reader.fail());
+            }
+        }
+    }
+}
+
+namespace {
+
+struct ClientReader : esb::BufferReader {
+    static constexpr size_t length_limit = 8;
+    using BufferReader::BufferReader;
+};
+
+}  // namespace
+
+SCENARIO("buffer readers reject lengths the input cannot hold", "[buffer_reader]") {
+    GIVEN("a string length prefix claiming more bytes than remain") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, uint16_t{0xFFFF});
+        os << "abc";
+        auto bytes = os.str();
+
+        WHEN("the string is read") {
+            esb::BufferReader reader{bytes};
+            std::string       tmp = "unchanged";
+            esb::read(reader, tmp);
+
+            THEN("the read fails before the string is resized") {
+                REQUIRE(reader.fail());
+                REQUIRE(tmp == "unchanged");
+            }
+        }
+    }
+
+    GIVEN("a vector element count claiming more elements than remain") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, uint32_t{1000000000});
+        esb::write(os, uint64_t{1});
+        auto bytes = os.str();
+
+        WHEN("the vector is read") {
+            esb::BufferReader     reader{bytes};
+            std::vector<uint64_t> tmp;
+            esb::read(reader, tmp);
+
+            THEN("the read fails without allocating") {
+                REQUIRE(reader.fail());
+                REQUIRE(tmp.capacity() == 0);
+            }
+        }
+
+        WHEN("a vector of strings is read") {
+            esb::BufferReader        reader{bytes};
+            std::vector<std::string> tmp;
+            esb::read(reader, tmp);
+
+            THEN("the read fails without allocating") {
+                REQUIRE(reader.fail());
+                REQUIRE(tmp.capacity() == 0);
+            }
+        }
+    }
+
+    GIVEN("a vector of strings whose count the input could only back with empty strings") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, uint32_t{30000});
+        esb::write(os, std::string("abc"));
+        esb::write(os, uint16_t{0xFFFF});
+        os << std::string(60000 - 5, '\0');
+        auto bytes = os.str();
+
+        WHEN("the vector is read") {
+            esb::BufferReader        reader{bytes};
+            std::vector<std::string> tmp;
+            esb::read(reader, tmp);
+
+            THEN("only the elements reached before the failure are created") {
+                REQUIRE(reader.fail());
+                REQUIRE(tmp.size() == 2);
+                REQUIRE(tmp.capacity() < 8);
+            }
+        }
+    }
+
+    GIVEN("a vector of strings whose count exceeds the input at the minimum string size") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, uint32_t{30001});
+        os << std::string(60000, '\0');
+        auto bytes = os.str();
+
+        WHEN("the vector is read") {
+            esb::BufferReader        reader{bytes};
+            std::vector<std::string> tmp;
+            esb::read(reader, tmp);
+
+            THEN("the read fails without allocating") {
+                REQUIRE(reader.fail());
+                REQUIRE(tmp.capacity() == 0);
+            }
+        }
+    }
+
+    GIVEN("hostile length prefixes on a standard stream, which cannot tell what remains") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("a string claiming 65535 bytes is followed by two") {
+            bs << std::string("\xFF\xFF" "ab", 4);
+            std::string tmp;
+            esb::read(bs, tmp);
+
+            THEN("the read fails having allocated no more than one chunk") {
+                REQUIRE(bs.fail());
+                REQUIRE(tmp.capacity() < 8192);
+            }
+        }
+
+        WHEN("a vector claiming 2^28 elements is followed by two bytes") {
+            bs << std::string("\x00\x00\x00\x10" "ab", 6);
+            std::vector<uint64_t> tmp;
+            esb::read(bs, tmp);
+
+            THEN("the read fails having allocated no more than one chunk") {
+                REQUIRE(bs.fail());
+                REQUIRE(tmp.capacity() < 1024);
+            }
+        }
+
+        WHEN("a vector claiming the largest count is followed by nothing") {
+            esb::write(bs, uint32_t{0xFFFFFFFF});
+            std::vector<uint64_t> tmp;
+            esb::read(bs, tmp, esb::little_endian{});
+
+            THEN("the read fails having allocated no more than one chunk") {
+                REQUIRE(bs.fail());
+                REQUIRE(tmp.capacity() < 1024);
+            }
+        }
+
+        WHEN("a UTF-16 string claiming 2^28 code units is followed by two bytes") {
+            bs << std::string("\x00\x00\x00\x10" "ab", 6);
+            std::u16string tmp;
+            esb::read(bs, tmp);
+
+            THEN("the read fails having allocated no more than one chunk") {
+                REQUIRE(bs.fail());
+                REQUIRE(tmp.capacity() < 4096);
+            }
+        }
+    }
+
+    GIVEN("strings and vectors spanning several chunks on a standard stream") {
+        std::string           str(10000, 'x');
+        std::vector<uint64_t> values(10000);
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = i * 7;
+        }
+
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, str);
+        esb::write(bs, values);
+
+        WHEN("they are read back") {
+            auto tmpStr    = esb::read<std::string>(bs);
+            auto tmpValues = esb::read<std::vector<uint64_t>>(bs);
+
+            THEN("they match the values written") {
+                REQUIRE(bs.good());
+                REQUIRE(tmpStr == str);
+                REQUIRE(tmpValues == values);
+            }
+        }
+    }
+
+    GIVEN("a string longer than a length limit") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, std::string("a string of 25 characters"));
+        auto bytes = os.str();
+
+        WHEN("it is read with a per call limit") {
+            esb::BufferReader reader{bytes};
+            std::string       tmp;
+            esb::read(reader, tmp, esb::length_limit{16});
+
+            THEN("the read fails") { REQUIRE(reader.fail()); }
+        }
+
+        WHEN("it is read from a stream declaring a limit") {
+            ClientReader reader{bytes};
+            std::string  tmp;
+            esb::read(reader, tmp);
+
+            THEN("the read fails") {
+                REQUIRE(reader.fail());
+                REQUIRE(tmp.empty());
+            }
+        }
+
+        WHEN("it is read with a limit it fits within") {
+            esb::BufferReader reader{bytes};
+
+            THEN("the read succeeds") {
+                REQUIRE(esb::read<std::string>(reader, esb::length_limit{25}).length() == 25);
+            }
+        }
+    }
+}
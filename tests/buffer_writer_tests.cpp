@@ -0,0 +1,137 @@
+#include "buffer_writer.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "catch.hpp"
+
+SCENARIO("buffer writers can be used to serialize values", "[buffer_writer]") {
+    GIVEN("an empty buffer writer") {
+        esb::BufferWriter writer;
+
+        REQUIRE(writer.size() == 0);
+
+        WHEN("integral and string values are written to it") {
+            uint32_t    tmpInt = 0xDEADBEEF;
+            std::string tmpStr = "Some string value";
+            esb::write(writer, tmpInt);
+            esb::write(writer, tmpStr);
+
+            THEN("the output matches the output of a standard stream") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, tmpInt);
+                esb::write(os, tmpStr);
+
+                REQUIRE(std::string(writer.data(), writer.size()) == os.str());
+            }
+
+            AND_THEN("releasing the storage hands over the bytes and empties the writer") {
+                auto expectedData = writer.data();
+                auto bytes        = writer.release();
+
+                REQUIRE(bytes.data() == expectedData);
+                REQUIRE(bytes.size() == sizeof(uint32_t) + sizeof(uint16_t) + tmpStr.length());
+                REQUIRE(writer.size() == 0);
+            }
+        }
+
+        WHEN("a string too long for its length prefix is followed by another value") {
+            esb::write(writer, std::string(300, 'x'), esb::prefix::u8{});
+            esb::write(writer, uint32_t{1});
+
+            THEN("nothing is written, as with a standard stream") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, std::string(300, 'x'), esb::prefix::u8{});
+                esb::write(os, uint32_t{1});
+
+                REQUIRE(writer.fail());
+                REQUIRE(writer.size() == 0);
+                REQUIRE(os.str().empty());
+            }
+        }
+
+        WHEN("an empty vector is written to it") {
+            esb::write(writer, std::vector<uint8_t>{});
+
+            THEN("only the element count is written") {
+                REQUIRE(writer.good());
+                REQUIRE(writer.size() == sizeof(uint32_t));
+            }
+        }
+    }
+
+    GIVEN("a buffer writer with reserved capacity") {
+        esb::BufferWriter writer{64};
+        auto              data = writer.data();
+
+        WHEN("less than the reserved capacity is written") {
+            for (uint32_t i = 0; i < 16; ++i) {
+                esb::write(writer, i);
+            }
+
+            THEN("the storage is not reallocated") {
+                REQUIRE(writer.data() == data);
+                REQUIRE(writer.size() == 64);
+            }
+        }
+    }
+
+    GIVEN("a buffer writer with previously written data") {
+        esb::BufferWriter writer;
+        uint32_t          placeholder = 0;
+        uint16_t          body        = 0xABCD;
+        esb::write(writer, placeholder);
+        esb::write(writer, body);
+
+        WHEN("the write position is moved back and a value is written") {
+            uint32_t size = 2;
+            writer.seekp(0);
+            esb::write(writer, size);
+
+            THEN("the earlier value is overwritten in place") {
+                REQUIRE(writer.size() == 6);
+                REQUIRE(writer.data()[0] == 2);
+                REQUIRE(static_cast<uint8_t>(writer.data()[4]) == 0xCD);
+            }
+        }
+
+        WHEN("a value is written across the end of the data") {
+            uint32_t trailer = 0x11223344;
+            writer.seekp(4);
+            esb::write(writer, trailer);
+
+            THEN("it overwrites the tail and extends the data") {
+                REQUIRE(writer.size() == 8);
+                REQUIRE(writer.data()[0] == 0);
+                REQUIRE(writer.data()[4] == 0x44);
+                REQUIRE(writer.data()[7] == 0x11);
+            }
+        }
+    }
+}
+
+SCENARIO("buffer writers fill in reserved values in place", "[buffer_writer]") {
+    GIVEN("a buffer writer with a reserved value followed by enough output to regrow it") {
+        esb::BufferWriter writer;
+        auto              size = esb::reserve<uint32_t>(writer);
+        esb::write(writer, std::string(1000, 'x'));
+
+        WHEN("the value is filled in") {
+            size.set(1002);
+
+            THEN("the output matches writing the value in its place") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, uint32_t{1002});
+                esb::write(os, std::string(1000, 'x'));
+
+                REQUIRE(std::string(writer.data(), writer.size()) == os.str());
+            }
+
+            AND_THEN("the write position is unchanged") {
+                REQUIRE(writer.tellp() == std::streampos(1006));
+            }
+        }
+    }
+}
@@ -0,0 +1,399 @@
+#include "buffer_reader.hpp"
+#include "buffer_writer.hpp"
+#include "checked.hpp"
+#include "serialization.hpp"
+#include "unicode.hpp"
+
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+enum class Opcode : uint16_t { LOGIN = 1, MOVE = 2, CHAT = 3 };
+
+struct ChatMessage {
+    Opcode                opcode;
+    bool                  global;
+    std::string           text;
+    std::vector<uint32_t> recipients;
+
+    ESB_FIELDS(opcode, global, text, recipients)
+};
+
+enum class Channel : uint8_t { LOCAL = 0, GLOBAL = 1 };
+
+struct ChannelFlags {
+    std::array<Channel, 2> channels;
+    std::array<bool, 2>    muted;
+
+    ESB_FIELDS(channels, muted)
+};
+
+struct RawFlags {
+    bool muted[2];
+
+    ESB_FIELDS(muted)
+};
+
+std::string serialize(const ChatMessage& message) {
+    esb::BufferWriter writer;
+    esb::write(writer, message);
+    return {writer.data(), writer.size()};
+}
+
+}  // namespace
+
+template <>
+struct esb::enum_range<Opcode> {
+    static constexpr Opcode min = Opcode::LOGIN;
+    static constexpr Opcode max = Opcode::CHAT;
+};
+
+template <>
+struct esb::enum_range<Channel> {
+    static constexpr Channel min = Channel::LOCAL;
+    static constexpr Channel max = Channel::GLOBAL;
+};
+
+SCENARIO("checked reads report why input was rejected", "[checked]") {
+    GIVEN("a well formed message") {
+        auto bytes = serialize({Opcode::CHAT, true, "hello", {1, 2, 3}});
+
+        WHEN("it is read with checks") {
+            esb::BufferReader reader{bytes};
+            auto              message = esb::tryRead<ChatMessage>(reader);
+
+            THEN("the message is decoded") {
+                REQUIRE(message);
+                REQUIRE(message->opcode == Opcode::CHAT);
+                REQUIRE(message->text == "hello");
+                REQUIRE(message->recipients.size() == 3);
+            }
+        }
+
+        WHEN("it is truncated within a value") {
+            esb::BufferReader reader{bytes.data(), 4};
+            auto              message = esb::tryRead<ChatMessage>(reader);
+
+            THEN("the read fails as truncated") {
+                REQUIRE_FALSE(message);
+                REQUIRE(message.error() == esb::errc::truncated);
+            }
+        }
+
+        WHEN("it is truncated within a container") {
+            esb::BufferReader reader{bytes.data(), bytes.size() - 1};
+            auto              message = esb::tryRead<ChatMessage>(reader);
+
+            THEN("the element count is rejected before the container is allocated") {
+                REQUIRE(message.error() == esb::errc::length_overflow);
+            }
+        }
+
+        WHEN("it is read from a standard stream") {
+            std::stringstream ss(bytes.substr(0, 3), std::ios_base::in | std::ios_base::binary);
+            auto              message = esb::tryRead<ChatMessage>(ss);
+
+            THEN("truncation is detected from the stream state") {
+                REQUIRE(message.error() == esb::errc::truncated);
+            }
+        }
+    }
+
+    GIVEN("a message with an out of range enum") {
+        auto bytes = serialize({static_cast<Opcode>(9), true, "hello", {}});
+
+        WHEN("it is read with checks") {
+            esb::BufferReader reader{bytes};
+            auto              message = esb::tryRead<ChatMessage>(reader);
+
+            THEN("the enum is rejected and the stream flagged") {
+                REQUIRE(message.error() == esb::errc::invalid_enum);
+                REQUIRE(reader.fail());
+            }
+        }
+    }
+
+    GIVEN("a message with an invalid bool") {
+        auto bytes = serialize({Opcode::CHAT, true, "hello", {}});
+        bytes[2]   = 7;
+
+        WHEN("it is read with checks") {
+            esb::BufferReader reader{bytes};
+
+            THEN("the bool is rejected") {
+                REQUIRE(esb::tryRead<ChatMessage>(reader).error() == esb::errc::invalid_value);
+            }
+        }
+    }
+
+    GIVEN("a message whose length prefix exceeds the input") {
+        auto bytes = serialize({Opcode::CHAT, true, "hello", {}});
+        bytes[3]   = static_cast<char>(0xFF);
+
+        WHEN("it is read with checks") {
+            esb::BufferReader reader{bytes};
+            std::string       text;
+            reader.seekg(3);
+
+            THEN("the length is rejected before the string is allocated") {
+                REQUIRE(esb::tryRead(reader, text) == esb::errc::length_overflow);
+                REQUIRE(text.capacity() < 0xFF);
+            }
+        }
+    }
+}
+
+SCENARIO("checked reads check every element of fixed length arrays", "[checked]") {
+    GIVEN("arrays of ranged enums and bools holding invalid values") {
+        std::string bytes = "\x09\x09\x07\x07";
+
+        WHEN("they are read with checks") {
+            esb::BufferReader reader{bytes};
+            ChannelFlags      flags{};
+
+            THEN("the enum is rejected") {
+                REQUIRE(esb::tryRead(reader, flags) == esb::errc::invalid_enum);
+            }
+        }
+
+        WHEN("only the bools are invalid") {
+            bytes[0] = 1;
+            bytes[1] = 0;
+            esb::BufferReader reader{bytes};
+            ChannelFlags      flags{};
+
+            THEN("the bool is rejected") {
+                REQUIRE(esb::tryRead(reader, flags) == esb::errc::invalid_value);
+            }
+
+            AND_THEN("validation rejects it too") {
+                REQUIRE(esb::validate<ChannelFlags>(reader) == esb::errc::invalid_value);
+            }
+        }
+
+        WHEN("they are validated") {
+            esb::BufferReader reader{bytes};
+
+            THEN("the enum is rejected") {
+                REQUIRE(esb::validate<ChannelFlags>(reader) == esb::errc::invalid_enum);
+            }
+        }
+
+        WHEN("a built-in array of bools is read with checks") {
+            esb::BufferReader reader{bytes.data() + 2, 2};
+            RawFlags          flags{};
+
+            THEN("the bool is rejected") {
+                REQUIRE(esb::tryRead(reader, flags) == esb::errc::invalid_value);
+                REQUIRE(esb::validate<RawFlags>(reader) == esb::errc::invalid_value);
+            }
+        }
+    }
+
+    GIVEN("arrays holding valid values") {
+        std::string bytes("\x01\x00\x00\x01", 4);
+
+        WHEN("they are read with checks") {
+            esb::BufferReader reader{bytes};
+            ChannelFlags      flags{};
+            auto              error = esb::tryRead(reader, flags);
+
+            THEN("they are decoded") {
+                REQUIRE(error == esb::errc::ok);
+                REQUIRE(flags.channels[0] == Channel::GLOBAL);
+                REQUIRE(flags.muted[1]);
+            }
+        }
+    }
+}
+
+SCENARIO("checked reads report overlong UTF-16 strings as length overflows", "[checked]") {
+    GIVEN("a UTF-16 code unit count exceeding the input") {
+        esb::BufferWriter writer;
+        esb::write(writer, uint32_t{1000});
+        esb::write(writer, uint32_t{0x00620061});
+        std::string bytes{writer.data(), writer.size()};
+
+        WHEN("it is read as a std::u16string") {
+            esb::BufferReader reader{bytes};
+            std::u16string    tmp;
+
+            THEN("the count is rejected before the string is allocated") {
+                REQUIRE(esb::tryRead(reader, tmp) == esb::errc::length_overflow);
+                REQUIRE(tmp.capacity() < 1000);
+            }
+        }
+
+        WHEN("it is read through as_utf16") {
+            esb::BufferReader reader{bytes};
+            std::string       tmp;
+
+            THEN("the count is rejected") {
+                REQUIRE(esb::tryRead(reader, esb::as_utf16(tmp)) == esb::errc::length_overflow);
+            }
+        }
+
+        WHEN("it is validated") {
+            esb::BufferReader reader{bytes};
+
+            THEN("the count is rejected") {
+                REQUIRE(esb::validate<std::u16string>(reader) == esb::errc::length_overflow);
+            }
+        }
+    }
+
+    GIVEN("a UTF-16 string with an unpaired surrogate") {
+        esb::BufferWriter writer;
+        esb::write(writer, std::u16string{u'a', static_cast<char16_t>(0xD800)});
+        std::string bytes{writer.data(), writer.size()};
+
+        WHEN("it is read through as_utf16") {
+            esb::BufferReader reader{bytes};
+            std::string       tmp;
+
+            THEN("the string is rejected as an invalid value") {
+                REQUIRE(esb::tryRead(reader, esb::as_utf16(tmp)) == esb::errc::invalid_value);
+            }
+        }
+    }
+
+    GIVEN("a well formed UTF-16 string") {
+        esb::BufferWriter writer;
+        esb::write(writer, std::u16string(u"hello"));
+        std::string bytes{writer.data(), writer.size()};
+
+        WHEN("it is read with checks") {
+            esb::BufferReader reader{bytes};
+            std::u16string    units;
+            std::string       text;
+            auto              unitsError = esb::tryRead(reader, units);
+            reader.seekg(0);
+            auto textError = esb::tryRead(reader, esb::as_utf16(text));
+
+            THEN("it is decoded either way") {
+                REQUIRE(unitsError == esb::errc::ok);
+                REQUIRE(textError == esb::errc::ok);
+                REQUIRE(units == u"hello");
+                REQUIRE(text == "hello");
+            }
+        }
+    }
+}
+
+SCENARIO("checked reads bound allocation by the input on hostile counts", "[checked]") {
+    GIVEN("a vector of messages whose count exceeds what the input could hold") {
+        esb::BufferWriter writer;
+        esb::write(writer, uint32_t{6000});
+        esb::write(writer, ChatMessage{Opcode::CHAT, true, "hello", {}});
+        esb::write(writer, std::string(60000, '\0'));
+
+        WHEN("it is read with checks") {
+            esb::BufferReader        reader{writer.data(), writer.size()};
+            std::vector<ChatMessage> messages;
+            auto                     error = esb::tryRead(reader, messages);
+
+            THEN("the read fails having created only the messages it reached") {
+                REQUIRE(error == esb::errc::invalid_enum);
+                REQUIRE(messages.size() == 2);
+                REQUIRE(messages.capacity() < 8);
+            }
+        }
+    }
+
+    GIVEN("a count exceeding the input at the minimum size of a message") {
+        esb::BufferWriter writer;
+        esb::write(writer, uint32_t{6700});
+        esb::write(writer, std::string(60000, '\0'));
+
+        WHEN("it is read with checks") {
+            esb::BufferReader        reader{writer.data(), writer.size()};
+            std::vector<ChatMessage> messages;
+
+            THEN("the count is rejected before anything is allocated") {
+                REQUIRE(esb::tryRead(reader, messages) == esb::errc::length_overflow);
+                REQUIRE(messages.capacity() == 0);
+            }
+        }
+    }
+
+    GIVEN("hostile counts on a standard stream, which cannot tell what remains") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        bs << std::string("\x00\x00\x00\x10" "ab", 6);
+
+        WHEN("a vector claiming 2^28 elements is read with checks") {
+            std::vector<uint64_t> values;
+            auto                  error = esb::tryRead(bs, values);
+
+            THEN("the read fails having allocated no more than one chunk") {
+                REQUIRE(error == esb::errc::truncated);
+                REQUIRE(values.capacity() < 1024);
+            }
+        }
+
+        WHEN("a string claiming 2^28 bytes is read with checks") {
+            std::string str;
+            auto        error = esb::tryRead(bs, str, esb::prefix::u32{});
+
+            THEN("the read fails having allocated no more than one chunk") {
+                REQUIRE(error == esb::errc::truncated);
+                REQUIRE(str.capacity() < 8192);
+            }
+        }
+    }
+}
+
+SCENARIO("messages can be validated once and then decoded unchecked", "[checked]") {
+    GIVEN("a buffer of well formed messages") {
+        esb::BufferWriter writer;
+        esb::write(writer, ChatMessage{Opcode::LOGIN, false, "a", {1}});
+        esb::write(writer, ChatMessage{Opcode::MOVE, true, "bc", {}});
+        std::string bytes{writer.data(), writer.size()};
+
+        WHEN("the first message is validated") {
+            esb::BufferReader reader{bytes};
+            auto              error = esb::validate<ChatMessage>(reader);
+
+            THEN("validation succeeds without moving the reader") {
+                REQUIRE(error == esb::errc::ok);
+                REQUIRE(reader.position() == 0);
+            }
+
+            AND_THEN("the message decodes without checks") {
+                auto message = esb::read<ChatMessage>(reader);
+
+                REQUIRE(reader.good());
+                REQUIRE(message.recipients == std::vector<uint32_t>{1});
+            }
+        }
+
+        WHEN("a run of fixed size values is validated") {
+            esb::BufferReader reader{bytes};
+
+            THEN("a single bounds check decides the outcome") {
+                using Small = std::array<uint8_t, 16>;
+                using Large = std::array<uint8_t, 64>;
+
+                REQUIRE(esb::validate<Small>(reader) == esb::errc::ok);
+                REQUIRE(esb::validate<Large>(reader) == esb::errc::truncated);
+            }
+        }
+    }
+
+    GIVEN("a message with an out of range enum") {
+        auto bytes = serialize({static_cast<Opcode>(0), true, "hello", {}});
+
+        WHEN("it is validated") {
+            esb::BufferReader reader{bytes};
+
+            THEN("validation fails") {
+                REQUIRE(esb::validate<ChatMessage>(reader) == esb::errc::invalid_enum);
+            }
+        }
+    }
+}
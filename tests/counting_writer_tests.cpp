@@ -0,0 +1,145 @@
+#include "counting_writer.hpp"
+#include "serialization.hpp"
+#include "unicode.hpp"
+#include "varint.hpp"
+
+#include <array>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+struct Waypoint {
+    float    x;
+    float    y;
+    uint16_t flags;
+
+    ESB_FIELDS(x, y, flags)
+};
+
+struct Route {
+    uint32_t              id;
+    std::string           name;
+    std::vector<Waypoint> waypoints;
+    esb::varint<uint64_t> distance;
+
+    ESB_FIELDS(id, name, waypoints, distance)
+};
+
+struct ShortStringCounter : esb::CountingWriter {
+    using length_prefix = esb::prefix::u8;
+};
+
+template <typename T>
+size_t writtenSize(const T& val) {
+    std::ostringstream os{std::stringstream::binary};
+    esb::write(os, val);
+    return os.str().length();
+}
+
+}  // namespace
+
+static_assert(esb::serialized_size<uint64_t>() == 8, "");
+static_assert(esb::serialized_size<Waypoint>() == 10, "");
+static_assert(esb::serialized_size<std::array<Waypoint, 4>>() == 40, "");
+static_assert(esb::serialized_size(esb::varint<uint32_t>{300}) == 2, "");
+static_assert(!esb::is_fixed_size<Route>::value, "");
+
+SCENARIO("serialized sizes can be computed without writing", "[serialized_size]") {
+    GIVEN("fixed size values") {
+        THEN("their sizes match the number of bytes written") {
+            Waypoint waypoint{1.f, 2.f, 3};
+
+            REQUIRE(esb::serialized_size(int16_t{-1}) == writtenSize(int16_t{-1}));
+            REQUIRE(esb::serialized_size(waypoint) == writtenSize(waypoint));
+        }
+    }
+
+    GIVEN("variable size values") {
+        Route route{7, "harbour", {{1.f, 2.f, 3}, {4.f, 5.f, 6}}, {1u << 20}};
+
+        THEN("their sizes match the number of bytes written") {
+            REQUIRE(esb::serialized_size(std::string("abc")) == writtenSize(std::string("abc")));
+            REQUIRE(esb::serialized_size(route.waypoints) == writtenSize(route.waypoints));
+            REQUIRE(esb::serialized_size(std::u16string(u"abc")) ==
+                    writtenSize(std::u16string(u"abc")));
+            REQUIRE(esb::serialized_size(esb::zigzag<int32_t>{-65}) ==
+                    writtenSize(esb::zigzag<int32_t>{-65}));
+            REQUIRE(esb::serialized_size(route) == writtenSize(route));
+        }
+
+        AND_THEN("strings can be measured with an explicit length prefix") {
+            REQUIRE(esb::serialized_size("abc", esb::prefix::u8{}) == 4);
+            REQUIRE(esb::serialized_size(std::string(200, 'x'), esb::prefix::varint{}) == 202);
+            REQUIRE(esb::serialized_size(std::string(300, 'x'), esb::prefix::u8{}) == 0);
+        }
+
+        AND_THEN("strings are measured by the number of UTF-16 code units they transcode to") {
+            std::string str = "\xC3\xBC\xF0\x9F\x98\x80";
+            REQUIRE(esb::serialized_size(esb::as_utf16(str)) == writtenSize(esb::as_utf16(str)));
+        }
+    }
+}
+
+SCENARIO("counting writers measure output without storing it", "[counting_writer]") {
+    GIVEN("an empty counting writer") {
+        esb::CountingWriter writer;
+
+        REQUIRE(writer.size() == 0);
+
+        WHEN("values are written to it") {
+            esb::write(writer, uint32_t{1});
+            esb::write(writer, std::string("Some string value"));
+
+            THEN("its size is the number of bytes a standard stream receives") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, uint32_t{1});
+                esb::write(os, std::string("Some string value"));
+
+                REQUIRE(writer.good());
+                REQUIRE(writer.size() == os.str().length());
+            }
+        }
+
+        WHEN("earlier output is overwritten after seeking back") {
+            esb::write(writer, uint64_t{1});
+            writer.seekp(0);
+            esb::write(writer, uint32_t{2});
+
+            THEN("the size is unaffected") {
+                REQUIRE(writer.size() == sizeof(uint64_t));
+                REQUIRE(writer.tellp() == std::streampos(sizeof(uint32_t)));
+            }
+        }
+
+        WHEN("it seeks beyond its end") {
+            writer.seekp(4);
+
+            THEN("the writer reports the failure") { REQUIRE(writer.fail()); }
+        }
+    }
+
+    GIVEN("a counting writer declaring a length prefix") {
+        ShortStringCounter writer;
+
+        WHEN("a string is written to it") {
+            esb::write(writer, std::string("abc"));
+
+            THEN("the count reflects the declared prefix") { REQUIRE(writer.size() == 4); }
+        }
+
+        WHEN("a string too long for the prefix is followed by another value") {
+            esb::write(writer, std::string(300, 'x'));
+            esb::write(writer, uint32_t{1});
+
+            THEN("the writer fails without counting what followed") {
+                REQUIRE(writer.fail());
+                REQUIRE(writer.size() == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "buffer_reader.hpp"
+#include "buffer_writer.hpp"
+#include "dispatch.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+struct Login {
+    static constexpr uint32_t opcode = esb::crc32("Login");
+
+    std::string name;
+
+    ESB_FIELDS(name)
+};
+
+struct Move {
+    static constexpr uint32_t opcode = esb::crc32("Move");
+
+    uint32_t entity;
+    float    x;
+    float    y;
+
+    ESB_FIELDS(entity, x, y)
+};
+
+struct Logout {
+    uint8_t reason;
+
+    ESB_FIELDS(reason)
+};
+
+struct Recorder {
+    std::vector<std::string> names;
+    std::vector<uint32_t>    entities;
+    std::vector<uint8_t>     reasons;
+
+    void operator()(const Login& msg) { names.push_back(msg.name); }
+    void operator()(const Move& msg) { entities.push_back(msg.entity); }
+    void operator()(const Logout& msg) { reasons.push_back(msg.reason); }
+};
+
+}  // namespace
+
+template <>
+struct esb::opcode_of<Logout> : std::integral_constant<uint32_t, 7> {};
+
+static_assert(esb::crc32("123456789") == 0xCBF43926, "crc32 must match the IEEE check value");
+
+SCENARIO("messages can be dispatched to handlers by opcode", "[dispatch]") {
+    using Dispatcher = esb::Dispatcher<Login, Move, Logout>;
+
+    static_assert(Dispatcher::contains(Login::opcode), "registered opcodes must be found");
+    static_assert(Dispatcher::contains(7), "specialized opcodes must be found");
+    static_assert(!Dispatcher::contains(esb::crc32("Chat")), "unknown opcodes must not be found");
+
+    GIVEN("a buffer of messages each preceded by its opcode") {
+        esb::BufferWriter writer;
+        esb::write(writer, Login::opcode);
+        esb::write(writer, Login{"alice"});
+        esb::write(writer, Move::opcode);
+        esb::write(writer, Move{3, 1.f, 2.f});
+        esb::write(writer, uint32_t{7});
+        esb::write(writer, Logout{2});
+        esb::write(writer, Move::opcode);
+        esb::write(writer, Move{4, 1.f, 2.f});
+
+        esb::BufferReader reader{writer.data(), writer.size()};
+        Dispatcher        dispatcher;
+        Recorder          recorder;
+
+        WHEN("every message is dispatched") {
+            size_t handled = 0;
+            while (dispatcher.dispatch(reader, recorder)) {
+                ++handled;
+            }
+
+            THEN("each reaches the handler for its type in order") {
+                std::vector<uint32_t> expectedEntities = {3, 4};
+
+                REQUIRE(handled == 4);
+                REQUIRE(reader.remaining() == 0);
+                REQUIRE(recorder.names == std::vector<std::string>{"alice"});
+                REQUIRE(recorder.entities == expectedEntities);
+                REQUIRE(recorder.reasons == std::vector<uint8_t>{2});
+            }
+
+            AND_THEN("messages are decoded into objects owned by the dispatcher") {
+                REQUIRE(dispatcher.message<Move>().entity == 4);
+                REQUIRE(dispatcher.message<Login>().name == "alice");
+            }
+        }
+    }
+
+    GIVEN("a message with an unregistered opcode") {
+        esb::BufferWriter writer;
+        esb::write(writer, Move{3, 1.f, 2.f});
+
+        esb::BufferReader reader{writer.data(), writer.size()};
+        Dispatcher        dispatcher;
+        Recorder          recorder;
+
+        WHEN("it is dispatched") {
+            bool handled = dispatcher.dispatch(reader, esb::crc32("Chat"), recorder);
+
+            THEN("it is rejected without consuming the body") {
+                REQUIRE_FALSE(handled);
+                REQUIRE(reader.good());
+                REQUIRE(reader.remaining() == writer.size());
+            }
+        }
+    }
+
+    GIVEN("a truncated message body") {
+        esb::BufferWriter writer;
+        esb::write(writer, Move{3, 1.f, 2.f});
+
+        esb::BufferReader reader{writer.data(), writer.size() - 1};
+        Dispatcher        dispatcher;
+        Recorder          recorder;
+
+        WHEN("it is dispatched") {
+            bool handled = dispatcher.dispatch(reader, Move::opcode, recorder);
+
+            THEN("the handler is not called and the stream is flagged") {
+                REQUIRE_FALSE(handled);
+                REQUIRE(reader.fail());
+                REQUIRE(recorder.entities.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#include "buffer_writer.hpp"
+#include "framing.hpp"
+#include "inline_writer.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+enum class Opcode : uint16_t { MOVE = 1, CHAT = 2 };
+
+struct Move {
+    uint32_t entity;
+    float    x;
+    float    y;
+
+    ESB_FIELDS(entity, x, y)
+};
+
+}  // namespace
+
+SCENARIO("messages can be coalesced into frames and walked back", "[framing]") {
+    GIVEN("a buffer of framed messages") {
+        esb::BufferWriter                                     writer;
+        esb::FrameWriter<esb::BufferWriter, uint16_t, Opcode> frames{writer};
+
+        frames.write(Opcode::MOVE, Move{7, 1.f, 2.f});
+        frames.write(Opcode::CHAT, std::string("hello"));
+
+        auto start = frames.begin(Opcode::MOVE);
+        esb::write(writer, Move{8, 3.f, 4.f});
+        frames.end(start);
+
+        THEN("each frame is a size and opcode header followed by the body") {
+            std::ostringstream os{std::stringstream::binary};
+            esb::write(os, uint16_t{12});
+            esb::write(os, Opcode::MOVE);
+            esb::write(os, Move{7, 1.f, 2.f});
+
+            REQUIRE(frames.count() == 3);
+            REQUIRE(std::string(writer.data(), 16) == os.str());
+        }
+
+        WHEN("the buffer is walked") {
+            esb::FrameReader<uint16_t, Opcode> received{writer.data(), writer.size()};
+            std::vector<Opcode>                opcodes;
+            std::vector<uint32_t>              entities;
+            std::string                        chat;
+
+            for (auto frame : received) {
+                opcodes.push_back(frame.opcode);
+                if (frame.opcode == Opcode::MOVE) {
+                    entities.push_back(esb::read<Move>(frame.body).entity);
+                } else {
+                    chat = esb::read<std::string>(frame.body);
+                }
+            }
+
+            THEN("every message is yielded in order") {
+                std::vector<Opcode>   expectedOpcodes  = {Opcode::MOVE, Opcode::CHAT, Opcode::MOVE};
+                std::vector<uint32_t> expectedEntities = {7, 8};
+
+                REQUIRE_FALSE(received.fail());
+                REQUIRE(opcodes == expectedOpcodes);
+                REQUIRE(entities == expectedEntities);
+                REQUIRE(chat == "hello");
+            }
+        }
+
+        WHEN("the last frame is truncated") {
+            esb::FrameReader<uint16_t, Opcode> received{writer.data(), writer.size() - 1};
+            size_t                             count = 0;
+
+            for (auto it = received.begin(); it != received.end(); ++it) {
+                ++count;
+            }
+
+            THEN("iteration stops before it and reports the failure") {
+                REQUIRE(count == 2);
+                REQUIRE(received.fail());
+            }
+        }
+    }
+
+    GIVEN("a frame with a body too large for its size field") {
+        esb::InlineWriter<512>                                    writer;
+        esb::FrameWriter<esb::InlineWriter<512>, uint8_t, Opcode> frames{writer};
+
+        WHEN("it is written") {
+            frames.write(Opcode::CHAT, std::string(300, 'x'));
+
+            THEN("the stream is flagged") {
+                REQUIRE(writer.fail());
+                REQUIRE(frames.count() == 0);
+            }
+        }
+    }
+}
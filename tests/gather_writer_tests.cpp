@@ -0,0 +1,96 @@
+#include "gather_writer.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+std::string concatenate(const esb::GatherWriter& writer) {
+    std::string bytes;
+    for (size_t i = 0; i < writer.segmentCount(); ++i) {
+        bytes += writer.segment(i);
+    }
+    return bytes;
+}
+
+}  // namespace
+
+SCENARIO("gather writers reference large payloads instead of copying them", "[gather_writer]") {
+    GIVEN("a gather writer with a 64 byte threshold") {
+        esb::GatherWriter writer{64};
+
+        WHEN("small fields surround a large string") {
+            std::string attachment(1000, 'x');
+            esb::write(writer, uint32_t{7});
+            esb::write(writer, std::string("subject"));
+            esb::write(writer, attachment);
+            esb::write(writer, uint16_t{1});
+
+            THEN("the output matches the output of a standard stream") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, uint32_t{7});
+                esb::write(os, std::string("subject"));
+                esb::write(os, attachment);
+                esb::write(os, uint16_t{1});
+
+                REQUIRE(writer.good());
+                REQUIRE(writer.size() == os.str().length());
+                REQUIRE(concatenate(writer) == os.str());
+            }
+
+            AND_THEN("the large string is a segment of its own pointing at its bytes") {
+                REQUIRE(writer.segmentCount() == 3);
+                REQUIRE(writer.segment(1).data() == attachment.data());
+                REQUIRE(writer.segment(1).size() == attachment.size());
+            }
+
+            AND_THEN("the segments are exposed as iovecs") {
+                const auto& iov = writer.iovecs();
+
+                REQUIRE(iov.size() == 3);
+                REQUIRE(iov[1].iov_base == attachment.data());
+                REQUIRE(iov[0].iov_len + iov[1].iov_len + iov[2].iov_len == writer.size());
+            }
+        }
+
+        WHEN("a large array of integers is written") {
+            std::vector<uint32_t> blob(100, 0xABCDEF01);
+            esb::write(writer, blob);
+
+            THEN("the count is copied and the elements are referenced") {
+                REQUIRE(writer.segmentCount() == 2);
+                REQUIRE(writer.segment(0).size() == sizeof(uint32_t));
+                REQUIRE(writer.segment(1).data() == reinterpret_cast<const char*>(blob.data()));
+            }
+        }
+
+        WHEN("a string too long for its length prefix is followed by other values") {
+            std::string attachment(1000, 'x');
+            esb::write(writer, std::string(300, 'y'), esb::prefix::u8{});
+            esb::write(writer, uint32_t{7});
+            esb::write(writer, attachment);
+
+            THEN("the writer fails and neither copies nor references anything") {
+                REQUIRE(writer.fail());
+                REQUIRE(writer.size() == 0);
+                REQUIRE(writer.segmentCount() == 0);
+            }
+        }
+
+        WHEN("the writer is reset") {
+            esb::write(writer, std::string(100, 'y'));
+            writer.reset();
+            esb::write(writer, uint8_t{1});
+
+            THEN("only the new output remains") {
+                REQUIRE(writer.size() == 1);
+                REQUIRE(writer.segmentCount() == 1);
+            }
+        }
+    }
+}
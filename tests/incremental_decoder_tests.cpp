@@ -0,0 +1,159 @@
+#include "buffer_reader.hpp"
+#include "buffer_writer.hpp"
+#include "incremental_decoder.hpp"
+#include "serialization.hpp"
+#include "varint.hpp"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+struct Item {
+    std::string              name;
+    esb::varint<uint32_t>    count;
+    esb::zigzag<int64_t>     delta;
+    std::array<uint16_t, 3>  slots;
+    std::vector<std::string> tags;
+
+    ESB_FIELDS(name, count, delta, slots, tags)
+};
+
+struct Snapshot {
+    uint64_t              tick;
+    std::vector<Item>     items;
+    std::vector<uint32_t> entities;
+    bool                  compressed;
+
+    ESB_FIELDS(tick, items, entities, compressed)
+};
+
+Snapshot makeSnapshot() {
+    Snapshot snapshot{0x0102030405060708, {}, {}, true};
+
+    for (uint32_t i = 0; i < 5; ++i) {
+        snapshot.items.push_back({std::string(40 + i, 'a' + i),
+                                  {i * 300},
+                                  {-static_cast<int64_t>(i) * 70000},
+                                  {{1, 2, static_cast<uint16_t>(i)}},
+                                  {"tag", std::string(i * 7, 't')}});
+    }
+
+    for (uint32_t i = 0; i < 100; ++i) {
+        snapshot.entities.push_back(i * 0x01010101);
+    }
+
+    return snapshot;
+}
+
+void requireEqual(const Snapshot& lhs, const Snapshot& rhs) {
+    REQUIRE(lhs.tick == rhs.tick);
+    REQUIRE(lhs.items.size() == rhs.items.size());
+    for (size_t i = 0; i < lhs.items.size(); ++i) {
+        REQUIRE(lhs.items[i].name == rhs.items[i].name);
+        REQUIRE(lhs.items[i].count.value == rhs.items[i].count.value);
+        REQUIRE(lhs.items[i].delta.value == rhs.items[i].delta.value);
+        REQUIRE(lhs.items[i].slots == rhs.items[i].slots);
+        REQUIRE(lhs.items[i].tags == rhs.items[i].tags);
+    }
+    REQUIRE(lhs.entities == rhs.entities);
+    REQUIRE(lhs.compressed == rhs.compressed);
+}
+
+struct ClientReader : esb::BufferReader {
+    static constexpr size_t length_limit = 8;
+    using BufferReader::BufferReader;
+};
+
+}  // namespace
+
+SCENARIO("messages can be decoded from input arriving in pieces", "[incremental_decoder]") {
+    GIVEN("a serialized message") {
+        auto              expected = makeSnapshot();
+        esb::BufferWriter writer;
+        esb::write(writer, expected);
+
+        std::string bytes(writer.data(), writer.size());
+
+        WHEN("it is fed one byte at a time") {
+            esb::IncrementalDecoder<Snapshot> decoder;
+
+            size_t fed = 0;
+            while (fed < bytes.size() && !decoder.done()) {
+                REQUIRE_FALSE(decoder.fail());
+                fed += decoder.feed(bytes.data() + fed, 1);
+            }
+
+            THEN("it completes with the last byte and matches the message") {
+                REQUIRE(decoder.done());
+                REQUIRE(fed == bytes.size());
+                requireEqual(decoder.value(), expected);
+            }
+        }
+
+        WHEN("it is fed in chunks of varying size") {
+            THEN("every chunking yields the same message") {
+                for (size_t chunk : {2, 3, 5, 7, 13, 64, 1400}) {
+                    esb::IncrementalDecoder<Snapshot> decoder;
+
+                    for (size_t fed = 0; fed < bytes.size(); fed += chunk) {
+                        auto size = chunk < bytes.size() - fed ? chunk : bytes.size() - fed;
+                        decoder.feed(bytes.data() + fed, size);
+                    }
+
+                    REQUIRE(decoder.done());
+                    requireEqual(decoder.value(), expected);
+                }
+            }
+        }
+    }
+
+    GIVEN("two messages received back to back") {
+        esb::BufferWriter writer;
+        esb::write(writer, std::string("first"));
+        esb::write(writer, std::string("second"));
+
+        std::string                          bytes(writer.data(), writer.size());
+        esb::IncrementalDecoder<std::string> decoder;
+
+        WHEN("the whole input is fed at once") {
+            auto consumed = decoder.feed(bytes);
+
+            THEN("only the first message is consumed") {
+                REQUIRE(decoder.done());
+                REQUIRE(consumed == 7);
+                REQUIRE(decoder.value() == "first");
+            }
+
+            AND_THEN("the remainder decodes as the next message after a reset") {
+                decoder.reset();
+                decoder.feed(bytes.data() + consumed, bytes.size() - consumed);
+
+                REQUIRE(decoder.done());
+                REQUIRE(decoder.value() == "second");
+            }
+        }
+    }
+
+    GIVEN("a string longer than the limit of the stream type") {
+        esb::BufferWriter writer;
+        esb::write(writer, std::string("longer than eight"));
+
+        esb::IncrementalDecoder<std::string, ClientReader> decoder;
+
+        WHEN("its length prefix arrives") {
+            decoder.feed(writer.data(), 2);
+
+            THEN("decoding fails before any of the string is stored") {
+                REQUIRE(decoder.fail());
+                REQUIRE_FALSE(decoder.done());
+                REQUIRE(decoder.value().empty());
+                REQUIRE(decoder.feed(writer.data() + 2, writer.size() - 2) == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#include "inline_writer.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "catch.hpp"
+
+SCENARIO("inline writers can be used to serialize values", "[inline_writer]") {
+    enum class TEST_ENUM : uint32_t { TEST1 = 1, TEST2 = 2 };
+
+    GIVEN("an empty inline writer") {
+        esb::InlineWriter<32> writer;
+
+        REQUIRE(writer.size() == 0);
+        REQUIRE(writer.capacity() == 32);
+
+        WHEN("values that fit within its capacity are written to it") {
+            uint16_t    tmpInt  = 0xABCD;
+            TEST_ENUM   tmpEnum = TEST_ENUM::TEST2;
+            std::string tmpStr  = "Some string value";
+            esb::write(writer, tmpInt);
+            esb::write(writer, tmpEnum);
+            esb::write(writer, tmpStr);
+
+            THEN("the output matches the output of a standard stream") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, tmpInt);
+                esb::write(os, tmpEnum);
+                esb::write(os, tmpStr);
+
+                REQUIRE(writer.good());
+                REQUIRE(writer.view() == os.str());
+            }
+        }
+
+        WHEN("an empty vector is written to it") {
+            esb::write(writer, std::vector<uint8_t>{});
+
+            THEN("only the element count is written") {
+                REQUIRE(writer.good());
+                REQUIRE(writer.size() == sizeof(uint32_t));
+            }
+        }
+
+        WHEN("a value that exceeds its capacity is written to it") {
+            uint64_t    tmpInt = 1;
+            std::string tmpStr = "A string value too long to fit";
+            esb::write(writer, tmpInt);
+            esb::write(writer, tmpStr);
+
+            THEN("the writer reports the overflow") {
+                REQUIRE(writer.fail());
+                REQUIRE(writer.bad());
+            }
+
+            AND_THEN("the values written before the overflow are retained") {
+                REQUIRE(writer.size() == sizeof(uint64_t) + sizeof(uint16_t));
+            }
+
+            AND_THEN("further writes are ignored") {
+                uint8_t tmp = 1;
+                esb::write(writer, tmp);
+
+                REQUIRE(writer.size() == sizeof(uint64_t) + sizeof(uint16_t));
+            }
+
+            AND_THEN("values reserved afterwards are never filled in") {
+                auto size = esb::reserve<uint32_t>(writer);
+                size.set(0xFFFFFFFF);
+
+                REQUIRE(writer.size() == sizeof(uint64_t) + sizeof(uint16_t));
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "mapped_file_reader.hpp"
+#include "serialization.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "catch.hpp"
+
+namespace {
+
+// Path of a new scratch file in the temporary directory, rather than wherever the tests are run
+// from, named at random so that concurrent runs from different build trees do not collide.
+std::string scratchPath() {
+    auto name = "esb_mapped_file_reader_test_" + std::to_string(std::random_device{}()) + ".bin";
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+// Writes bytes to a scratch file that is removed when the object goes out of scope.
+struct ScratchFile {
+    explicit ScratchFile(const std::string& bytes) {
+        std::ofstream file(path, std::ios_base::out | std::ios_base::binary);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    ~ScratchFile() { std::remove(path.c_str()); }
+
+    std::string path = scratchPath();
+};
+
+}  // namespace
+
+SCENARIO("mapped file readers can be used to deserialize values", "[mapped_file_reader]") {
+    GIVEN("a file containing serialized values") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, uint32_t{0xDEADBEEF});
+        esb::write(os, std::string("Some string value"));
+        esb::write(os, uint64_t{42});
+        ScratchFile file{os.str()};
+
+        WHEN("it is mapped") {
+            esb::MappedFileReader reader{file.path.c_str()};
+            reader.advise(esb::access_hint::sequential);
+
+            THEN("the values read match the values written") {
+                REQUIRE(reader.isOpen());
+                REQUIRE(reader.size() == os.str().length());
+                REQUIRE(esb::read<uint32_t>(reader) == 0xDEADBEEF);
+                REQUIRE(esb::read<std::string_view>(reader) == "Some string value");
+                REQUIRE(esb::read<uint64_t>(reader) == 42);
+                REQUIRE(reader.good());
+            }
+
+            AND_THEN("values can be read at arbitrary offsets") {
+                const auto view = reader.view();
+
+                REQUIRE(esb::peekAt<uint64_t>(reader, reader.size() - 8) == 42);
+                REQUIRE(esb::peekAt<uint32_t>(view, 0) == 0xDEADBEEF);
+            }
+
+            AND_THEN("the mapping moves with the reader") {
+                auto                  data = reader.data();
+                esb::MappedFileReader moved{std::move(reader)};
+
+                REQUIRE(moved.data() == data);
+                REQUIRE(reader.size() == 0);
+                REQUIRE(esb::read<uint32_t>(moved) == 0xDEADBEEF);
+            }
+        }
+    }
+
+    GIVEN("an empty file") {
+        ScratchFile file{""};
+
+        WHEN("it is mapped") {
+            esb::MappedFileReader reader{file.path.c_str()};
+
+            THEN("the reader is open but reads fail") {
+                REQUIRE(reader.isOpen());
+                REQUIRE(reader.size() == 0);
+
+                esb::read<uint8_t>(reader);
+                REQUIRE(reader.fail());
+            }
+        }
+    }
+
+    GIVEN("a path that does not exist") {
+        WHEN("it is mapped") {
+            esb::MappedFileReader reader{"esb_mapped_file_reader_missing.bin"};
+
+            THEN("the reader reports the failure") {
+                REQUIRE_FALSE(reader.isOpen());
+                REQUIRE(reader.fail());
+            }
+        }
+    }
+}
@@ -0,0 +1,131 @@
+#include "segmented_reader.hpp"
+#include "serialization.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catch.hpp"
+
+namespace {
+
+// Splits bytes into chunks of the given size, as a receive loop would.
+std::vector<std::string_view> split(const std::string& bytes, size_t chunkSize) {
+    std::vector<std::string_view> segments;
+    for (size_t i = 0; i < bytes.size(); i += chunkSize) {
+        segments.emplace_back(bytes.data() + i, std::min(chunkSize, bytes.size() - i));
+    }
+    return segments;
+}
+
+}  // namespace
+
+SCENARIO("segmented readers decode values spanning several buffers", "[segmented_reader]") {
+    GIVEN("serialized values split into small segments") {
+        std::ostringstream os{std::stringstream::binary};
+        esb::write(os, uint32_t{0xDEADBEEF});
+        esb::write(os, std::string("a string that straddles several segments"));
+        esb::write(os, std::vector<uint16_t>(5, 9));
+        esb::write(os, uint64_t{42});
+        auto bytes    = os.str();
+        auto segments = split(bytes, 5);
+        auto heights  = std::vector<uint16_t>(5, 9);
+
+        WHEN("they are read back") {
+            esb::SegmentedReader reader{segments};
+
+            THEN("the values read match the values written") {
+                REQUIRE(reader.size() == bytes.size());
+                REQUIRE(esb::read<uint32_t>(reader) == 0xDEADBEEF);
+                REQUIRE(esb::read<std::string>(reader) ==
+                        "a string that straddles several segments");
+                REQUIRE(esb::read<std::vector<uint16_t>>(reader) == heights);
+                REQUIRE(esb::read<uint64_t>(reader) == 42);
+                REQUIRE(reader.good());
+                REQUIRE(reader.remaining() == 0);
+            }
+        }
+
+        WHEN("a value is read past the end") {
+            esb::SegmentedReader reader{segments};
+            reader.seekg(-2, std::ios_base::end);
+            esb::read<uint32_t>(reader);
+
+            THEN("the short read is flagged") {
+                REQUIRE(reader.fail());
+                REQUIRE(reader.eof());
+                REQUIRE(reader.gcount() == 2);
+            }
+        }
+
+        WHEN("values are read at arbitrary offsets") {
+            esb::SegmentedReader reader{segments};
+            esb::read<uint32_t>(reader);
+
+            THEN("they can be reached across segment boundaries") {
+                REQUIRE(esb::peekAt<uint64_t>(reader, bytes.size() - 8) == 42);
+                REQUIRE(reader.position() == sizeof(uint32_t));
+                REQUIRE(esb::readAt<uint32_t>(reader, 0) == 0xDEADBEEF);
+                REQUIRE(esb::read<uint16_t>(reader) == 40);
+            }
+        }
+
+        WHEN("values are read at arbitrary offsets of a const reader") {
+            esb::SegmentedReader reader{segments};
+            esb::read<uint32_t>(reader);
+            const auto& constReader = reader;
+
+            THEN("the reader's cursor and state are untouched") {
+                REQUIRE(esb::peekAt<uint64_t>(constReader, bytes.size() - 8) == 42);
+                REQUIRE(esb::readAt<uint32_t>(constReader, 0) == 0xDEADBEEF);
+                esb::peekAt<uint64_t>(constReader, bytes.size() - 2);
+
+                REQUIRE(reader.good());
+                REQUIRE(reader.position() == sizeof(uint32_t));
+            }
+        }
+
+        WHEN("the reader seeks back and forth") {
+            esb::SegmentedReader reader{segments};
+
+            THEN("each seek lands on the right byte") {
+                reader.seekg(static_cast<std::streamoff>(bytes.size() - 8));
+                REQUIRE(esb::read<uint64_t>(reader) == 42);
+                reader.seekg(0);
+                REQUIRE(esb::read<uint32_t>(reader) == 0xDEADBEEF);
+                reader.seekg(-8, std::ios_base::end);
+                reader.seekg(-4, std::ios_base::cur);
+                REQUIRE(esb::read<uint32_t>(reader) == 0x00090009);
+                REQUIRE(reader.position() == bytes.size() - 8);
+            }
+        }
+    }
+
+    GIVEN("a chain containing empty segments") {
+        std::string                   bytes{"\x01\x02\x03\x04", 4};
+        std::vector<std::string_view> segments{{bytes.data(), 1}, {}, {bytes.data() + 1, 3}, {}};
+
+        WHEN("a value spanning them is read") {
+            esb::SegmentedReader reader{segments};
+
+            THEN("the empty segments are skipped") {
+                REQUIRE(esb::read<uint32_t>(reader) == 0x04030201);
+                REQUIRE(reader.good());
+            }
+        }
+
+        WHEN("it seeks back to a boundary next to an empty segment") {
+            esb::SegmentedReader reader{segments};
+            reader.seekg(0, std::ios_base::end);
+            reader.seekg(1);
+
+            THEN("the bytes after the boundary are read") {
+                REQUIRE(esb::read<uint16_t>(reader) == 0x0302);
+                REQUIRE(reader.position() == 3);
+            }
+        }
+    }
+}
@@ -1,7 +1,9 @@
 
 #include "serialization.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory_resource>
 
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
 #include "catch.hpp"
@@ -400,3 +402,511 @@ SCENARIO("booleans can be serialized and deserialzed", "[booleans]") {
         }
     }
 }
+
+SCENARIO("floating point types can be serialized and deserialized", "[floats]") {
+    GIVEN("a binary stream containing a serialized float and double") {
+        float             expectedFloat  = 1.5f;
+        double            expectedDouble = -2.25;
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, expectedFloat);
+        esb::write(bs, expectedDouble);
+
+        THEN("the serialized output size is the size of the values") {
+            REQUIRE(bs.str().length() == sizeof(float) + sizeof(double));
+        }
+
+        WHEN("the values are read from the stream") {
+            auto tmpFloat  = esb::read<float>(bs);
+            auto tmpDouble = esb::read<double>(bs);
+
+            THEN("the values read are the values expected") {
+                REQUIRE(tmpFloat == expectedFloat);
+                REQUIRE(tmpDouble == expectedDouble);
+            }
+        }
+    }
+}
+
+SCENARIO("contiguous containers can be serialized and deserialized", "[containers]") {
+    GIVEN("a vector of integral values and a binary stream") {
+        std::vector<uint16_t> values = {1, 2, 3, 0xABCD};
+        std::stringstream     bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("the vector is written to the stream") {
+            esb::write(bs, values);
+
+            THEN("the output contains a uint32_t element count followed by the elements") {
+                auto str = bs.str();
+
+                REQUIRE(str.length() == sizeof(uint32_t) + values.size() * sizeof(uint16_t));
+                REQUIRE(esb::peekAt<uint32_t>(bs, 0) == values.size());
+                REQUIRE(static_cast<uint8_t>(str[10]) == 0xCD);
+                REQUIRE(static_cast<uint8_t>(str[11]) == 0xAB);
+            }
+
+            AND_THEN("the vector read back matches the vector written") {
+                auto tmp = esb::read<std::vector<uint16_t>>(bs);
+
+                REQUIRE(tmp == values);
+            }
+        }
+    }
+
+    GIVEN("a vector of strings and a binary stream") {
+        std::vector<std::string> values = {"first", "", "third"};
+        std::stringstream        bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, values);
+
+        WHEN("the vector is read from the stream") {
+            auto tmp = esb::read<std::vector<std::string>>(bs);
+
+            THEN("each element is serialized individually") {
+                REQUIRE(bs.str().length() == sizeof(uint32_t) + 3 * sizeof(uint16_t) + 10);
+                REQUIRE(tmp == values);
+            }
+        }
+    }
+
+    GIVEN("fixed size arrays and a binary stream") {
+        std::array<float, 3> position = {1.f, 2.f, 3.f};
+        int32_t              heights[4] = {-1, 0, 1, 2};
+        std::stringstream    bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("the arrays are written to the stream") {
+            esb::write(bs, position);
+            esb::write(bs, heights);
+
+            THEN("the output contains only the elements") {
+                REQUIRE(bs.str().length() == sizeof(position) + sizeof(heights));
+            }
+
+            AND_THEN("the arrays read back match the arrays written") {
+                auto    tmpPosition = esb::read<std::array<float, 3>>(bs);
+                int32_t tmpHeights[4];
+                esb::read(bs, tmpHeights);
+
+                REQUIRE(tmpPosition == position);
+                REQUIRE(std::equal(std::begin(heights), std::end(heights), tmpHeights));
+            }
+        }
+    }
+}
+
+namespace {
+
+struct BigEndianStream : std::stringstream {
+    using byte_order = esb::big_endian;
+    using std::stringstream::stringstream;
+};
+
+}  // namespace
+
+SCENARIO("values can be serialized with an explicit byte order", "[byte_order]") {
+    GIVEN("an empty binary output stream") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("a 32 bit value is written as big endian") {
+            uint32_t tmp = 0x01020304;
+            esb::write(bs, tmp, esb::big_endian{});
+
+            THEN("the serialized output is big endian") {
+                auto str = bs.str();
+
+                REQUIRE(str == std::string("\x01\x02\x03\x04", 4));
+            }
+
+            AND_THEN("reading it back as big endian yields the value written") {
+                REQUIRE(esb::read<uint32_t>(bs, esb::big_endian{}) == tmp);
+            }
+        }
+
+        WHEN("a value is written with the native byte order") {
+            uint16_t tmp = 0x0102;
+            esb::write(bs, tmp, esb::native{});
+
+            THEN("the serialized output matches the default output") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, tmp);
+
+                REQUIRE(bs.str() == os.str());
+            }
+        }
+
+        WHEN("a vector of values is written as big endian") {
+            std::vector<uint32_t> values(37);
+            for (uint32_t i = 0; i < values.size(); ++i) {
+                values[i] = 0x01020300 + i;
+            }
+
+            esb::write(bs, values, esb::big_endian{});
+
+            THEN("the count and every element are big endian") {
+                auto str = bs.str();
+
+                REQUIRE(str.substr(0, 4) == std::string("\x00\x00\x00\x25", 4));
+                REQUIRE(str.substr(4 + 36 * 4, 4) == std::string("\x01\x02\x03\x24", 4));
+            }
+
+            AND_THEN("reading it back as big endian yields the values written") {
+                std::vector<uint32_t> tmp;
+                esb::read(bs, tmp, esb::big_endian{});
+
+                REQUIRE(tmp == values);
+            }
+        }
+    }
+
+    GIVEN("a stream that declares a big endian byte order") {
+        BigEndianStream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("a string and an enum are written to the stream") {
+            enum class TEST_ENUM : uint16_t { TEST1 = 1 };
+            esb::write(bs, std::string("abc"));
+            esb::write(bs, TEST_ENUM::TEST1);
+
+            THEN("the string length and the enum are big endian") {
+                REQUIRE(bs.str() == std::string("\x00\x03" "abc" "\x00\x01", 7));
+            }
+
+            AND_THEN("the values read back match the values written") {
+                REQUIRE(esb::read<std::string>(bs) == "abc");
+                REQUIRE(esb::read<TEST_ENUM>(bs) == TEST_ENUM::TEST1);
+            }
+        }
+    }
+}
+
+namespace {
+
+struct ShortStringStream : std::stringstream {
+    using length_prefix = esb::prefix::u8;
+    using std::stringstream::stringstream;
+};
+
+}  // namespace
+
+SCENARIO("strings can be serialized with different length prefixes", "[strings]") {
+    GIVEN("an empty binary stream") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("a string longer than 65535 bytes is written with a 32 bit prefix") {
+            std::string large(70000, 'x');
+            esb::write(bs, large, esb::prefix::u32{});
+
+            THEN("the whole string is written after a uint32_t length") {
+                REQUIRE(bs.str().length() == sizeof(uint32_t) + large.length());
+                REQUIRE(esb::peekAt<uint32_t>(bs, 0) == large.length());
+            }
+
+            AND_THEN("the string read back matches the string written") {
+                REQUIRE(esb::read<std::string>(bs, esb::prefix::u32{}) == large);
+            }
+        }
+
+        WHEN("a string longer than 65535 bytes is written with the default prefix") {
+            std::string large(70000, 'x');
+            esb::write(bs, large);
+
+            THEN("nothing is written and the stream reports the failure") {
+                REQUIRE(bs.fail());
+                REQUIRE(bs.str().empty());
+            }
+        }
+
+        WHEN("a string is written with a varint prefix") {
+            std::string str(200, 'x');
+            esb::write(bs, str, esb::prefix::varint{});
+
+            THEN("the length is varint encoded") {
+                REQUIRE(bs.str().length() == 2 + str.length());
+            }
+
+            AND_THEN("the string read back matches the string written") {
+                std::string tmp;
+                esb::read(bs, tmp, esb::prefix::varint{});
+
+                REQUIRE(tmp == str);
+            }
+        }
+    }
+
+    GIVEN("a stream that declares an 8 bit length prefix") {
+        ShortStringStream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("a string is written to the stream") {
+            esb::write(bs, "abc");
+
+            THEN("the string is preceded by a single length byte") {
+                REQUIRE(bs.str() == std::string("\x03" "abc", 4));
+            }
+
+            AND_THEN("the string read back matches the string written") {
+                REQUIRE(esb::read<std::string>(bs) == "abc");
+            }
+        }
+    }
+}
+
+namespace {
+
+struct Vector3 {
+    float x;
+    float y;
+    float z;
+
+    ESB_FIELDS(x, y, z)
+};
+
+struct PlayerState {
+    uint64_t             id;
+    std::string          name;
+    Vector3              position;
+    std::vector<Vector3> waypoints;
+
+    ESB_FIELDS(id, name, position, waypoints)
+};
+
+}  // namespace
+
+SCENARIO("structs declaring their fields can be serialized and deserialized", "[structs]") {
+    GIVEN("an initialized struct and a binary stream") {
+        PlayerState state{42, "player", {1.f, 2.f, 3.f}, {{4.f, 5.f, 6.f}, {7.f, 8.f, 9.f}}};
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("the struct is written to the stream") {
+            esb::write(bs, state);
+
+            THEN("the output is identical to writing each field by hand") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, state.id);
+                esb::write(os, state.name);
+                esb::write(os, state.position.x);
+                esb::write(os, state.position.y);
+                esb::write(os, state.position.z);
+                esb::write(os, static_cast<uint32_t>(state.waypoints.size()));
+                for (auto& waypoint : state.waypoints) {
+                    esb::write(os, waypoint.x);
+                    esb::write(os, waypoint.y);
+                    esb::write(os, waypoint.z);
+                }
+
+                REQUIRE(bs.str() == os.str());
+            }
+
+            AND_THEN("the struct read back matches the struct written") {
+                auto tmp = esb::read<PlayerState>(bs);
+
+                REQUIRE(tmp.id == state.id);
+                REQUIRE(tmp.name == state.name);
+                REQUIRE(tmp.position.z == state.position.z);
+                REQUIRE(tmp.waypoints.size() == 2);
+                REQUIRE(tmp.waypoints[1].y == state.waypoints[1].y);
+            }
+        }
+    }
+}
+
+namespace {
+
+#pragma pack(push, 1)
+struct PositionUpdate {
+    uint64_t id;
+    float    x;
+    float    y;
+    float    z;
+    uint16_t heading;
+
+    ESB_FIELDS(id, x, y, z, heading)
+};
+#pragma pack(pop)
+
+struct PaddedUpdate {
+    uint64_t id;
+    uint16_t heading;
+
+    ESB_FIELDS(id, heading)
+};
+
+}  // namespace
+
+template <>
+struct esb::is_wire_compatible<PositionUpdate> : std::true_type {};
+
+SCENARIO("wire compatible structs are serialized as raw bytes", "[structs]") {
+    GIVEN("a packed struct opted in as wire compatible") {
+        PositionUpdate update{42, 1.f, 2.f, 3.f, 90};
+
+        THEN("its layout is verified at compile time") {
+            REQUIRE(esb::detail::has_wire_layout<PositionUpdate>::value);
+            REQUIRE_FALSE(esb::detail::has_wire_layout<PaddedUpdate>::value);
+        }
+
+        WHEN("it is written to a stream") {
+            std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+            esb::write(bs, update);
+
+            THEN("the output is identical to writing each field by hand") {
+                // Packed members may be misaligned, so each is copied out before being passed on
+                // by reference.
+                uint64_t id      = update.id;
+                float    x       = update.x;
+                float    y       = update.y;
+                float    z       = update.z;
+                uint16_t heading = update.heading;
+
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, id);
+                esb::write(os, x);
+                esb::write(os, y);
+                esb::write(os, z);
+                esb::write(os, heading);
+
+                REQUIRE(bs.str() == os.str());
+            }
+
+            AND_THEN("the struct read back matches the struct written") {
+                auto     tmp     = esb::read<PositionUpdate>(bs);
+                uint64_t id      = tmp.id;
+                float    z       = tmp.z;
+                uint16_t heading = tmp.heading;
+
+                REQUIRE(id == 42);
+                REQUIRE(z == 3.f);
+                REQUIRE(heading == 90);
+            }
+        }
+
+        WHEN("a vector of them is written to a stream") {
+            std::vector<PositionUpdate> updates{update, {43, 4.f, 5.f, 6.f, 180}};
+            std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+            esb::write(bs, updates);
+
+            THEN("the output is a count followed by the raw structs") {
+                REQUIRE(bs.str().length() == sizeof(uint32_t) + 2 * sizeof(PositionUpdate));
+            }
+
+            AND_THEN("the vector read back matches the vector written") {
+                auto     tmp     = esb::read<std::vector<PositionUpdate>>(bs);
+                uint64_t id      = tmp[1].id;
+                uint16_t heading = tmp[1].heading;
+
+                REQUIRE(tmp.size() == 2);
+                REQUIRE(id == 43);
+                REQUIRE(heading == 180);
+            }
+        }
+
+        WHEN("it is written to a stream with a non-native byte order") {
+            BigEndianStream bs;
+            esb::write(bs, update);
+
+            THEN("each field is byte swapped individually") {
+                uint64_t id      = update.id;
+                float    x       = update.x;
+                float    y       = update.y;
+                float    z       = update.z;
+                uint16_t heading = update.heading;
+
+                BigEndianStream os;
+                esb::write(os, id);
+                esb::write(os, x);
+                esb::write(os, y);
+                esb::write(os, z);
+                esb::write(os, heading);
+
+                REQUIRE(bs.str() == os.str());
+
+                heading = esb::read<PositionUpdate>(bs).heading;
+                REQUIRE(heading == 90);
+            }
+        }
+    }
+}
+
+namespace {
+
+struct Inventory {
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    explicit Inventory(allocator_type alloc = {})
+        : owner{alloc}
+        , items{alloc} {}
+
+    std::pmr::string                   owner;
+    std::pmr::vector<std::pmr::string> items;
+
+    ESB_FIELDS(owner, items)
+};
+
+}  // namespace
+
+SCENARIO("strings and containers can be decoded into a memory resource", "[pmr]") {
+    GIVEN("a stream containing strings too long for the small string buffer") {
+        std::string              owner = "an owner name well beyond the small string size";
+        std::vector<std::string> items(8, "an item name well beyond the small string size");
+
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, owner);
+        esb::write(bs, items);
+
+        WHEN("they are read into a message allocated from a fixed arena") {
+            char                                buffer[4096];
+            std::pmr::monotonic_buffer_resource arena{buffer, sizeof(buffer),
+                                                      std::pmr::null_memory_resource()};
+            Inventory                           inventory{&arena};
+            esb::read(bs, inventory);
+
+            THEN("every string and container is allocated from the arena") {
+                REQUIRE(bs.good());
+                REQUIRE(inventory.owner == owner.c_str());
+                REQUIRE(inventory.items.size() == 8);
+                REQUIRE(inventory.items[7] == items[7].c_str());
+                REQUIRE(inventory.items[7].get_allocator().resource() == &arena);
+            }
+        }
+    }
+}
+
+SCENARIO("values can be reserved and filled in after what follows them", "[slots]") {
+    GIVEN("a stream with a reserved 32 bit value followed by a string") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        auto              size = esb::reserve<uint32_t>(bs);
+        esb::write(bs, std::string("abc"));
+
+        WHEN("the value is filled in") {
+            size.set(5);
+
+            THEN("the output matches writing the value in its place") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, uint32_t{5});
+                esb::write(os, std::string("abc"));
+
+                REQUIRE(bs.str() == os.str());
+            }
+
+            AND_THEN("further writes continue after the string") {
+                esb::write(bs, uint8_t{9});
+
+                REQUIRE(bs.str().size() == 10);
+                REQUIRE(bs.str()[9] == 9);
+            }
+        }
+    }
+
+    GIVEN("a stream that declares a big endian byte order") {
+        enum class Opcode : uint16_t { LOGIN = 0x0102 };
+
+        BigEndianStream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        auto            opcode = esb::reserve<Opcode>(bs);
+        auto            size   = esb::reserve<uint16_t>(bs, esb::little_endian{});
+
+        WHEN("the values are filled in") {
+            opcode.set(Opcode::LOGIN);
+            size.set(0x0304);
+
+            THEN("each is written in the byte order it was reserved with") {
+                REQUIRE(bs.str() == std::string("\x01\x02\x04\x03", 4));
+            }
+        }
+    }
+}
@@ -0,0 +1,183 @@
+#include "serialization.hpp"
+#include "unicode.hpp"
+
+#include <cstdint>
+#include <sstream>
+
+#include "catch.hpp"
+
+SCENARIO("utf-16 strings can be serialized and deserialized", "[unicode]") {
+    GIVEN("a utf-16 string and a binary stream") {
+        std::u16string    str = u"Grüße \U0001F600";
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("the string is written to the stream") {
+            esb::write(bs, str);
+
+            THEN("the output contains a uint32_t code unit count followed by the code units") {
+                REQUIRE(bs.str().length() == sizeof(uint32_t) + str.length() * sizeof(char16_t));
+                REQUIRE(esb::peekAt<uint32_t>(bs, 0) == str.length());
+            }
+
+            AND_THEN("the string read back matches the string written") {
+                REQUIRE(esb::read<std::u16string>(bs) == str);
+            }
+        }
+    }
+}
+
+SCENARIO("utf-8 strings can be serialized as utf-16", "[unicode]") {
+    GIVEN("a utf-8 string mixing long ascii runs with multi byte characters") {
+        std::string utf8 = "The quick brown fox jumps over the lazy dog. \xC3\xBC\xC3\x9F "
+                           "\xE2\x82\xAC \xF0\x9F\x98\x80 and some more ascii text to finish.";
+        std::u16string utf16 = u"The quick brown fox jumps over the lazy dog. üß "
+                               u"€ \U0001F600 and some more ascii text to finish.";
+
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("the string is written as utf-16") {
+            esb::write(bs, esb::as_utf16(utf8));
+
+            THEN("the output matches the equivalent utf-16 string") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, utf16);
+
+                REQUIRE(bs.str() == os.str());
+            }
+
+            AND_THEN("reading it back as utf-8 yields the original string") {
+                std::string tmp;
+                esb::read(bs, esb::as_utf16(tmp));
+
+                REQUIRE(bs.good());
+                REQUIRE(tmp == utf8);
+            }
+        }
+    }
+
+    GIVEN("a utf-8 string mixing runs of two byte characters with ascii") {
+        std::string    utf8;
+        std::u16string utf16;
+        for (int i = 0; i < 20; ++i) {
+            // Cyrillic, Greek and accented Latin, each a two byte sequence.
+            utf8 += "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xCE\xB1\xCE\xB2\xCE\xB3"
+                    "\xC3\xA9\xC3\xA8\xC3\xBC\xC3\xB1\xC3\xA7\xC3\xB8 and ascii ";
+            utf16 += u"Привет αβγéèüñçø and ascii ";
+        }
+
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("the string is written as utf-16") {
+            esb::write(bs, esb::as_utf16(utf8));
+
+            THEN("the output matches the equivalent utf-16 string") {
+                std::ostringstream os{std::stringstream::binary};
+                esb::write(os, utf16);
+
+                REQUIRE(bs.str() == os.str());
+            }
+
+            AND_THEN("reading it back as utf-8 yields the original string") {
+                std::string tmp;
+                esb::read(bs, esb::as_utf16(tmp));
+
+                REQUIRE(bs.good());
+                REQUIRE(tmp == utf8);
+            }
+        }
+    }
+
+    GIVEN("a utf-16 string longer than a single transcoding chunk") {
+        std::u16string utf16;
+        std::string    utf8;
+        for (int i = 0; i < 300; ++i) {
+            utf16 += u"ab\U0001F600";
+            utf8 += "ab\xF0\x9F\x98\x80";
+        }
+
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, utf16);
+
+        WHEN("it is read as utf-8") {
+            std::string tmp;
+            esb::read(bs, esb::as_utf16(tmp));
+
+            THEN("surrogate pairs split across chunks are joined") { REQUIRE(tmp == utf8); }
+        }
+    }
+
+    GIVEN("a surrogate pair split across chunks followed by a chunk of three byte characters") {
+        std::u16string utf16 = std::u16string(255, u'a') + u"\U0001F600";
+        std::string    utf8  = std::string(255, 'a') + "\xF0\x9F\x98\x80";
+        utf16.append(255, u'€');
+        for (int i = 0; i < 255; ++i) {
+            utf8 += "\xE2\x82\xAC";
+        }
+
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, utf16);
+
+        WHEN("it is read as utf-8") {
+            std::string tmp;
+            esb::read(bs, esb::as_utf16(tmp));
+
+            THEN("the second chunk transcodes in full") {
+                REQUIRE(bs.good());
+                REQUIRE(tmp == utf8);
+            }
+        }
+    }
+
+    GIVEN("malformed input") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("invalid utf-8 is written as utf-16") {
+            std::string invalid = "abc\xC3";
+            esb::write(bs, esb::as_utf16(invalid));
+
+            THEN("nothing is written and the stream reports the failure") {
+                REQUIRE(bs.fail());
+                REQUIRE(bs.str().empty());
+            }
+        }
+
+        WHEN("a run of overlong two byte sequences is written as utf-16") {
+            std::string invalid;
+            for (int i = 0; i < 8; ++i) {
+                invalid += "\xC1\xBF";
+            }
+            esb::write(bs, esb::as_utf16(invalid));
+
+            THEN("nothing is written and the stream reports the failure") {
+                REQUIRE(bs.fail());
+                REQUIRE(bs.str().empty());
+            }
+        }
+
+        WHEN("a run of two byte sequences ending in a truncated one is written as utf-16") {
+            std::string invalid;
+            for (int i = 0; i < 7; ++i) {
+                invalid += "\xD0\x9F";
+            }
+            invalid += "\xD0" "abc";
+            esb::write(bs, esb::as_utf16(invalid));
+
+            THEN("nothing is written and the stream reports the failure") {
+                REQUIRE(bs.fail());
+                REQUIRE(bs.str().empty());
+            }
+        }
+
+        WHEN("a utf-16 string with an unpaired surrogate is read as utf-8") {
+            esb::write(bs, std::u16string(u"a") + char16_t(0xDC00) + u"b");
+
+            std::string tmp;
+            esb::read(bs, esb::as_utf16(tmp));
+
+            THEN("the stream reports the failure") {
+                REQUIRE(bs.fail());
+                REQUIRE(tmp.empty());
+            }
+        }
+    }
+}
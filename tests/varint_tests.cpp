@@ -0,0 +1,169 @@
+#include "serialization.hpp"
+#include "varint.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#include "catch.hpp"
+
+SCENARIO("variable length integers can be serialized and deserialized", "[varint]") {
+    GIVEN("an empty binary stream") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+
+        WHEN("a value below 128 is written as a varint") {
+            esb::write(bs, esb::varint<uint64_t>{127});
+
+            THEN("it occupies a single byte") {
+                REQUIRE(bs.str() == std::string("\x7F", 1));
+            }
+        }
+
+        WHEN("a multi byte value is written as a varint") {
+            esb::write(bs, esb::varint<uint32_t>{300});
+
+            THEN("the output is LEB128 encoded") {
+                REQUIRE(bs.str() == std::string("\xAC\x02", 2));
+            }
+
+            AND_THEN("the value read back matches the value written") {
+                REQUIRE(esb::read<esb::varint<uint32_t>>(bs) == 300u);
+            }
+        }
+
+        WHEN("the largest 64 bit value is written as a varint") {
+            auto max = std::numeric_limits<uint64_t>::max();
+            esb::write(bs, esb::varint<uint64_t>{max});
+
+            THEN("it occupies ten bytes and round trips") {
+                REQUIRE(bs.str().length() == 10);
+                REQUIRE(esb::read<esb::varint<uint64_t>>(bs) == max);
+            }
+        }
+
+        WHEN("small negative values are written as zigzag varints") {
+            esb::write(bs, esb::zigzag<int32_t>{-1});
+            esb::write(bs, esb::zigzag<int32_t>{1});
+            esb::write(bs, esb::zigzag<int64_t>{std::numeric_limits<int64_t>::min()});
+
+            THEN("they are mapped to small unsigned values") {
+                auto str = bs.str();
+
+                REQUIRE(str[0] == 0x01);
+                REQUIRE(str[1] == 0x02);
+            }
+
+            AND_THEN("the values read back match the values written") {
+                REQUIRE(esb::read<esb::zigzag<int32_t>>(bs) == -1);
+                REQUIRE(esb::read<esb::zigzag<int32_t>>(bs) == 1);
+                REQUIRE(esb::read<esb::zigzag<int64_t>>(bs) == std::numeric_limits<int64_t>::min());
+            }
+        }
+    }
+
+    GIVEN("a stream containing a varint too large for the requested type") {
+        std::stringstream bs(std::ios_base::out | std::ios_base::in | std::ios_base::binary);
+        esb::write(bs, esb::varint<uint32_t>{70000});
+
+        WHEN("it is read as a 16 bit varint") {
+            esb::varint<uint16_t> tmp;
+            esb::read(bs, tmp);
+
+            THEN("the stream reports the failure") { REQUIRE(bs.fail()); }
+        }
+    }
+}
+
+SCENARIO("runs of variable length integers can be decoded in bulk", "[varint]") {
+    GIVEN("a buffer of mostly small varints with occasional large values") {
+        std::vector<uint32_t> values;
+        for (uint32_t i = 0; i < 1000; ++i) {
+            values.push_back(i % 37 == 0 ? i * 100000 : i % 100);
+        }
+
+        std::ostringstream os{std::stringstream::binary};
+        for (auto value : values) {
+            esb::write(os, esb::varint<uint32_t>{value});
+        }
+        auto bytes = os.str();
+
+        WHEN("the buffer is decoded in bulk") {
+            std::vector<uint32_t> tmp(values.size());
+            auto consumed = esb::decodeVarints(bytes.data(), bytes.size(), tmp.data(), tmp.size());
+
+            THEN("every value and the whole buffer are consumed") {
+                REQUIRE(consumed == bytes.size());
+                REQUIRE(tmp == values);
+            }
+        }
+
+        WHEN("the buffer is truncated") {
+            std::vector<uint32_t> tmp(values.size());
+            auto consumed =
+                esb::decodeVarints(bytes.data(), bytes.size() - 1, tmp.data(), tmp.size());
+
+            THEN("the decode fails") { REQUIRE(consumed == 0); }
+        }
+    }
+
+    GIVEN("a buffer mixing one, two and three byte varints with occasional longer ones") {
+        std::vector<uint32_t> values;
+        uint32_t              state = 12345;
+        for (size_t i = 0; i < 2000; ++i) {
+            state = state * 1103515245 + 12345;
+            auto mask = (1u << (state >> 8) % 22) - 1;
+            values.push_back(i % 53 == 0 ? state | 0x80000000 : (state >> 9) & mask);
+        }
+
+        std::ostringstream os{std::stringstream::binary};
+        for (auto value : values) {
+            esb::write(os, esb::varint<uint32_t>{value});
+        }
+        auto bytes = os.str();
+
+        WHEN("the buffer is decoded in bulk into 64 bit values") {
+            std::vector<uint64_t> expected(values.begin(), values.end());
+            std::vector<uint64_t> tmp(values.size());
+            auto consumed = esb::decodeVarints(bytes.data(), bytes.size(), tmp.data(), tmp.size());
+
+            THEN("the values decoded match the values written") {
+                REQUIRE(consumed == bytes.size());
+                REQUIRE(tmp == expected);
+            }
+        }
+
+        WHEN("the buffer is decoded in bulk into 32 bit values") {
+            std::vector<uint32_t> tmp(values.size());
+            auto consumed = esb::decodeVarints(bytes.data(), bytes.size(), tmp.data(), tmp.size());
+
+            THEN("the values decoded match the values written") {
+                REQUIRE(consumed == bytes.size());
+                REQUIRE(tmp == values);
+            }
+        }
+    }
+
+    GIVEN("a buffer of zigzag encoded values") {
+        std::vector<int64_t> values;
+        for (int64_t i = -100; i < 100; ++i) {
+            values.push_back(i * (i % 7 == 0 ? 1000000 : 1));
+        }
+
+        std::ostringstream os{std::stringstream::binary};
+        for (auto value : values) {
+            esb::write(os, esb::zigzag<int64_t>{value});
+        }
+        auto bytes = os.str();
+
+        WHEN("the buffer is decoded in bulk") {
+            std::vector<int64_t> tmp(values.size());
+            auto consumed = esb::decodeZigzags(bytes.data(), bytes.size(), tmp.data(), tmp.size());
+
+            THEN("the values decoded match the values written") {
+                REQUIRE(consumed == bytes.size());
+                REQUIRE(tmp == values);
+            }
+        }
+    }
+}